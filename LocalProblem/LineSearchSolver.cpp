@@ -5,6 +5,7 @@
  *      Author: forma
  */
 #include "LineSearchSolver.hpp"
+#include "Diagnostics.hpp"
 #include <exception>
 #include <iostream>
 #include <limits>
@@ -96,9 +97,9 @@ apsc::LinearSearchSolver::solve()
           newPoint=currentPoint;
           newValue=currentValue;
           if(status == 1)
-            std::cerr<<"Error in LinearSearchSolver: I have found a non-descent direction.";
+            diagnostics::count(diagnostics::Event::NonDescentDirection);
           else // if(not bounded) // this test is disabled for bounded problems
-            std::cerr<<"Error in LinearSearchSolver: I cannot satisfy the sufficient decrease condition.";
+            diagnostics::count(diagnostics::Event::BacktrackFailed);
         }
       else
         {
@@ -118,6 +119,8 @@ apsc::LinearSearchSolver::solve()
         }
     }
   if (status==0)status = iter < maxIter ? 0 : 3;
+  if (status==3)
+    diagnostics::count(diagnostics::Event::MaxIterations);
   return {this->currentValues, iter, status};
 }
 
@@ -140,7 +143,7 @@ apsc::LinearSearchSolver::backtrack(
   Scalar gradstep = currentValues.currentGradient.transpose() * searchDirection;
   if(gradstep >= 0.)
     {
-      std::cerr << gradstep << " not valid. Reverted to gradient\n";
+      diagnostics::count(diagnostics::Event::GradientFallback);
       searchDirection = -currentValues.currentGradient;
       gradstep = -searchDirection.squaredNorm();
     }
@@ -0,0 +1,243 @@
+/*
+ * ProjectedNewtonSolver.hpp
+ *
+ *  Statically dispatched version of LinearSearchSolver + NewtonDirection
+ *  for the local eikonal problems.
+ */
+
+#ifndef EXAMPLES_SRC_LINESEARCH_PROJECTEDNEWTONSOLVER_HPP_
+#define EXAMPLES_SRC_LINESEARCH_PROJECTEDNEWTONSOLVER_HPP_
+#include "Diagnostics.hpp"
+#include "LineSearch_options.hpp"
+#include "LineSearch_traits.hpp"
+#include "Optimization_options.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+namespace apsc
+{
+/*!
+ * The projected Newton line search of LinearSearchSolver with NewtonDirection,
+ * bounded to the segment [0,1] (DIM=1) or to the triangle
+ * \f$\lambda_i\ge 0,\ \lambda_0+\lambda_1\le 1\f$ (DIM=2).
+ *
+ * Everything is resolved at compile time: the cost functor is called
+ * directly (no std::function), the descent direction is not a virtual
+ * object, bounds are constants and all vectors and matrices are fixed size,
+ * so a solve does not allocate. The operations are the same, in the same
+ * order, as in the generic solver, so the results are identical bit by bit.
+ *
+ * @tparam DIM The number of variables (1 or 2)
+ * @tparam COST The cost functor: it must provide operator()(x), gradient(x)
+ * and hessian(x), like Eikonal::Phi
+ */
+template <std::size_t DIM, typename COST> class ProjectedNewtonSolver
+{
+public:
+  using Scalar = typename LineSearch_traits_base<DIM>::Scalar;
+  using Vector = typename LineSearch_traits_base<DIM>::Vector;
+  using Matrix = typename LineSearch_traits_base<DIM>::Matrix;
+  static_assert(DIM == 1u or DIM == 2u, "Only segments and triangles");
+
+  //! The analogue of OptimizationCurrentValues
+  struct CurrentValues
+  {
+    Scalar currentCostValue; //!< current cost.
+    Vector currentPoint;     //!< current point.
+    Vector currentGradient;  //!< current gradient.
+    Matrix currentHessian;   //!< current Hessian.
+  };
+
+  /*!
+   * @param cost The cost functor (kept by reference)
+   * @param opt The options for the line search iterations.
+   * @param lsOpt The options for the backtracking function.
+   */
+  ProjectedNewtonSolver(COST const &cost, OptimizationOptions const &opt,
+                        LineSearchOptions const &lsOpt)
+    : cost(cost), options(opt), lineSearchOptions(lsOpt)
+  {}
+
+  /*!
+   * Runs the iterations from a point inside the bounds.
+   * @return The final values, the number of iterations and the status, as
+   * LinearSearchSolver::solve()
+   */
+  std::tuple<CurrentValues, std::size_t, int>
+  solve(Vector const &initialPoint)
+  {
+    currentValues.currentPoint = initialPoint;
+    currentValues.currentGradient = cost.gradient(initialPoint);
+    currentValues.currentCostValue = cost(initialPoint);
+    currentValues.currentHessian = cost.hessian(initialPoint);
+
+    auto const &relTol = options.relTol;
+    auto const &absTol = options.absTol;
+    auto const &maxIter = options.maxIter;
+    auto       &currentPoint = currentValues.currentPoint;
+    auto       &currentValue = currentValues.currentCostValue;
+    auto       &currentGradient = currentValues.currentGradient;
+    auto       &currentHessian = currentValues.currentHessian;
+    auto        gradientNorm = currentGradient.norm();
+    auto const  testValue = relTol * gradientNorm;
+    std::size_t iter = 0;
+    auto        stepLength = 2 * absTol;
+    auto        valTol = absTol + relTol * std::abs(currentValue);
+    auto        valChange = 2 * valTol;
+    int         status = 0;
+    while(gradientNorm > (testValue + absTol) and stepLength > absTol and
+          valChange > valTol and iter < maxIter and status == 0)
+      {
+        Vector newPoint = currentPoint;
+        Scalar newValue = currentValue;
+        Vector dd = newtonDirection();
+        if(dd.norm() > absTol)
+          {
+            std::tie(newPoint, newValue, status) = backtrack(dd);
+          }
+        if(status != 0)
+          {
+            diagnostics::count(status == 1 ? diagnostics::Event::NonDescentDirection
+                                           : diagnostics::Event::BacktrackFailed);
+          }
+        else
+          {
+            stepLength = (newPoint - currentPoint).norm();
+            currentPoint = newPoint;
+            valChange = std::abs(currentValue - newValue);
+            currentValue = newValue;
+            currentGradient = cost.gradient(newPoint);
+            currentHessian = cost.hessian(newPoint);
+            gradientNorm = currentGradient.norm();
+            ++iter;
+          }
+      }
+    if(status == 0)
+      status = iter < maxIter ? 0 : 3;
+    if(status == 3)
+      diagnostics::count(diagnostics::Event::MaxIterations);
+    return {currentValues, iter, status};
+  }
+
+private:
+  //! NewtonDirection::operator() for the fixed bounds
+  Vector
+  newtonDirection() const
+  {
+    auto const &values = currentValues;
+    if constexpr(DIM == 1u)
+      {
+        bool active = ((values.currentPoint[0] == 0.0 and values.currentGradient[0] > 0) or
+                       (values.currentPoint[0] == 1.0 and values.currentGradient[0] < 0));
+        if(active)
+          return Vector::Zero();
+        else
+          return -values.currentHessian.inverse() * values.currentGradient;
+      }
+    else
+      {
+        constexpr double    eps = 100. * std::numeric_limits<double>::epsilon();
+        bool                active = false;
+        std::array<bool, 3> constrained = {false, false, false};
+        for(auto i = 0; i < values.currentPoint.size(); ++i)
+          {
+            constrained[i] = (values.currentPoint[i] == 0.0 and values.currentGradient[i] > 0);
+            active = active || constrained[i];
+          }
+        constrained[2] = (std::abs(values.currentPoint[0] + values.currentPoint[1] - 1) <= eps) and
+                         (values.currentGradient[0] + values.currentGradient[1]) <= 0.0;
+        active = active || constrained[2];
+        if(not active)
+          return -values.currentHessian.inverse() * values.currentGradient;
+        if((constrained[0] and constrained[1]) or
+           (values.currentPoint[0] == 1. and values.currentPoint[1] == 0. and
+            (values.currentGradient[1] - values.currentGradient[0]) >= 0. and
+            values.currentGradient[0] <= 0.) or
+           (values.currentPoint[0] == 0. and values.currentPoint[1] == 1. and
+            (values.currentGradient[1] - values.currentGradient[0]) <= 0. and
+            values.currentGradient[1] <= 0.))
+          {
+            // gradient is pushing outside the constrained area
+            return Vector::Zero();
+          }
+        Matrix Hi = values.currentHessian.inverse();
+        if(constrained[0])
+          {
+            Hi.row(0).fill(0.);
+            Hi.col(0).fill(0.);
+          }
+        else if(constrained[1])
+          {
+            Hi.row(1).fill(0.);
+            Hi.col(1).fill(0.);
+          }
+        else if(constrained[2])
+          {
+            Matrix const P3{Matrix::Identity() - 0.5 * Matrix::Ones()};
+            Hi = P3 * Hi * P3;
+          }
+        return -Hi * values.currentGradient;
+      }
+  }
+
+  //! LinearSearchSolver::backtrack()
+  std::tuple<Vector, Scalar, int>
+  backtrack(Vector &searchDirection) const
+  {
+    LineSearchOptions const &lsOptions = lineSearchOptions;
+    if(searchDirection.norm() < options.absTol)
+      return {currentValues.currentPoint, currentValues.currentCostValue, 0};
+    Scalar gradstep = currentValues.currentGradient.transpose() * searchDirection;
+    if(gradstep >= 0.)
+      {
+        diagnostics::count(diagnostics::Event::GradientFallback);
+        searchDirection = -currentValues.currentGradient;
+        gradstep = -searchDirection.squaredNorm();
+      }
+    Vector const &currentPoint = currentValues.currentPoint;
+    auto const   &maxIter = lsOptions.maxIter;
+    auto          alpha = lsOptions.initialStep;
+    unsigned int  iter = 0u;
+    Vector        nextPoint = project(currentPoint + alpha * searchDirection);
+    Scalar        nextValue = cost(nextPoint);
+    alpha = std::min(1.0, 1. / searchDirection.norm());
+    while((nextValue >= currentValues.currentCostValue +
+                          lsOptions.sufficientDecreaseCoefficient * alpha * gradstep) and
+          (iter < maxIter))
+      {
+        ++iter;
+        alpha *= lsOptions.stepSizeDecrementFactor;
+        nextPoint = project(currentPoint + alpha * searchDirection);
+        nextValue = cost(nextPoint);
+      }
+    int status = iter < maxIter ? 0 : 2;
+    return {nextPoint, nextValue, status};
+  }
+
+  //! LinearSearchSolver::project() with bounds [0,1]
+  static Vector
+  project(Vector const &newPoint)
+  {
+    Vector res = newPoint;
+    if constexpr(DIM == 2u)
+      {
+        double avg = std::min(1.0, res[0] + res[1]);
+        double jmp = res[0] - res[1];
+        res.coeffRef(0) = (avg + jmp) / 2.;
+        res.coeffRef(1) = (avg - jmp) / 2.;
+      }
+    for(auto &x : res)
+      x = std::clamp(x, 0.0, 1.0);
+    return res;
+  }
+
+  COST const         &cost;
+  OptimizationOptions options;
+  LineSearchOptions   lineSearchOptions;
+  CurrentValues       currentValues;
+};
+
+} // namespace apsc
+
+#endif /* EXAMPLES_SRC_LINESEARCH_PROJECTEDNEWTONSOLVER_HPP_ */
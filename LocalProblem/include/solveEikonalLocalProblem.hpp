@@ -6,9 +6,14 @@
 #include "LineSearch.hpp"
 #include "LineSearchSolver.hpp"
 #include "Phi.hpp"
+#include "ProjectedNewtonSolver.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <utility>
 namespace Eikonal
 {
 /*!
@@ -22,8 +27,69 @@ template <std::size_t PHDIM> struct EikonalSolution
   double  value; //! The value at the new point
   Vector  lambda; //! The value(s) of lambda (foot of the characteristics)
   int     status; //! 0= converged 1=no descent direction 2=no convergence
+  std::size_t iterations = 0; //! Newton or line search iterations (0 if not run)
 };
 
+/*!
+ * @brief The options of the iterative local solvers
+ *
+ * Carried by each solver instance, so that solves with different options
+ * may run at the same time.
+ */
+struct LocalSolverOptions
+{
+  apsc::OptimizationOptions optimization; //! Tolerances and max iterations
+  apsc::LineSearchOptions   lineSearch;   //! Options of the backtracking
+};
+
+/*!
+ * @brief The minimum of the local problem on a segment of the lambda space
+ *
+ * On the segment [la, lb] the function is
+ * \f$\alpha t+\beta+\sqrt{Pt^2+2Qt+R}\f$, convex: the stationary point is
+ * \f$t=-(\alpha s+Q)/P\f$ with \f$s=\sqrt{(PR-Q^2)/(P-\alpha^2)}\f$, clamped
+ * to [0,1]. If \f$\alpha^2\ge P\f$ the minimum is an end point.
+ *
+ * @param MM The matrix \f$E^TME\f$ of the simplex
+ * @param du The differences of the values, as in Phi
+ * @param la The first end point
+ * @param lb The second end point
+ * @return The minimum and its point, status 0
+ */
+template <std::size_t PHDIM, typename MMATRIX, typename VECTOREXT>
+EikonalSolution<PHDIM>
+minimizeOnSegment(MMATRIX const &MM, VECTOREXT const &du,
+                  typename EikonalSolution<PHDIM>::Vector const &la,
+                  typename EikonalSolution<PHDIM>::Vector const &lb)
+{
+  constexpr std::size_t DIM = PHDIM - 1u;
+  VECTOREXT             ea, d;
+  ea.template topRows<DIM>() = la;
+  ea(DIM) = 1.0;
+  d.template topRows<DIM>() = lb - la;
+  d(DIM) = 0.0;
+  VECTOREXT    MMd = MM * d;
+  double const P = d.dot(MMd);
+  double const Q = ea.dot(MMd);
+  double const R = ea.dot(MM * ea);
+  double const alpha = du.dot(d);
+  double const beta = du.dot(ea);
+  auto phi = [&](double t) {
+    return alpha * t + beta + std::sqrt(std::max(P * t * t + 2. * Q * t + R, 0.));
+  };
+
+  double t = phi(1.0) < phi(0.0) ? 1.0 : 0.0;
+  // With alpha^2 >= P phi is monotone and the minimum is an end point
+  if(P > alpha * alpha)
+    {
+      double const s = std::sqrt(std::max(P * R - Q * Q, 0.) / (P - alpha * alpha));
+      double const t_star = std::clamp(-(alpha * s + Q) / P, 0.0, 1.0);
+      if(phi(t_star) < phi(t))
+        t = t_star;
+    }
+  return {phi(t), la + t * (lb - la), 0};
+}
+
 /*!
  * @brief Driver for the local solver
  *
@@ -34,45 +100,50 @@ template <std::size_t PHDIM> class solveEikonalLocalProblem
 public:
   using Vector = apsc::LineSearch_traits::Vector;
   using Matrix = apsc::LineSearch_traits::Matrix;
-  //! I pass a simplex structure and the values in the constructor
+  //! I pass a simplex structure, the values and the options in the constructor
   //! @todo To save memory and time I have to store references in Phi
   template <typename SIMPLEX, typename VALUES>
-  solveEikonalLocalProblem(SIMPLEX &&simplex, VALUES &&values)
-    : my_phi{std::forward<SIMPLEX>(simplex), std::forward<VALUES>(values)}
+  solveEikonalLocalProblem(SIMPLEX &&simplex, VALUES &&values,
+                           LocalSolverOptions const &options = LocalSolverOptions{})
+    : my_phi{std::forward<SIMPLEX>(simplex), std::forward<VALUES>(values)},
+      options{options}
   {}
   /*!
    * Solves the local problem
+   *
+   * The minimum is often on a vertex or an edge of the base: those
+   * candidates are evaluated first, vertices then edges, and returned if
+   * they satisfy the optimality (KKT) conditions of the whole problem. Only
+   * otherwise the projected Newton method is run. If it fails, the best
+   * candidate is returned when it is better than the last iterate (the
+   * status is kept).
    */
   EikonalSolution<PHDIM>          //restituisce una struct
   operator()() const
   {
-    apsc::OptimizationData optimizationData;
-    optimizationData.NumberOfVariables = PHDIM - 1u;
-    optimizationData.costFunction = [this](const Vector &x) {
-      return this->my_phi(x);
-    };
-    optimizationData.gradient = [this](const Vector &x) {
-      return this->my_phi.gradient(x);
-    };
-
-    optimizationData.hessian = [this](const Vector &x) {
-      return this->my_phi.hessian(x);
-    };
     Vector initialPoint;
-    if constexpr(PHDIM == 3u)
-      {
-        setBounds(optimizationData, {0., 0.}, {1.0, 1.0});
-      }
-    else
-      {
-        setBounds(optimizationData, {0.0}, {1.0});
-      }
     initialPoint.fill(0.333);           //put lambdas = 1/3 all elements in the vector, it is the initial value
-    apsc::LinearSearchSolver solver(optimizationData,
-                                    std::make_unique<apsc::NewtonDirection>(),
-                                    optimizationOptions, lineSearchOptions);
-    solver.setInitialPoint(initialPoint);
-    auto [finalValues, numIter, status] = solver.solve();
+    return (*this)(initialPoint);
+  }
+  /*!
+   * Solves the local problem starting Newton from a given point
+   *
+   * @param initialPoint A point of the base, typically the lambda found by
+   * a previous solve of the same simplex (warm start)
+   */
+  EikonalSolution<PHDIM>
+  operator()(Vector const &initialPoint) const
+  {
+    bool optimal = false;
+    auto const candidate = lowerDimensionalMinimum(optimal);
+    if(optimal)
+      return candidate;
+
+    // Same iterations as apsc::LinearSearchSolver with a NewtonDirection,
+    // statically dispatched (see ProjectedNewtonSolver.hpp)
+    apsc::ProjectedNewtonSolver<PHDIM - 1u, Eikonal::Phi<PHDIM>> solver(
+      my_phi, options.optimization, options.lineSearch);
+    auto [finalValues, numIter, status] = solver.solve(initialPoint);
 #ifdef VERBOSE
     if(status == 0)
       std::cout << "Solver converged" << std::endl;
@@ -86,22 +157,141 @@ public:
               << "\nNumber of iterations=" << numIter << "\nStatus=" << status
               << std::endl;
 #endif
-    return {finalValues.currentCostValue, finalValues.currentPoint, status};
+    if(status != 0 and candidate.value < finalValues.currentCostValue)
+      return {candidate.value, candidate.lambda, status, numIter};
+    return {finalValues.currentCostValue, finalValues.currentPoint, status, numIter};
+  }
+  /*!
+   * Solves the local problem with apsc::LinearSearchSolver and the given
+   * descent direction instead of the projected Newton method
+   *
+   * The vertex and edge candidates are tried first, as in the other
+   * versions.
+   *
+   * @param initialPoint The starting point of the line search
+   * @param direction The descent direction (see apsc::DescentDirectionFactory).
+   * It is cloned, since a direction may keep a state during the iterations
+   */
+  EikonalSolution<PHDIM>
+  operator()(Vector const &initialPoint, apsc::DescentDirectionBase const &direction) const
+  {
+    bool optimal = false;
+    auto const candidate = lowerDimensionalMinimum(optimal);
+    if(optimal)
+      return candidate;
+
+    apsc::OptimizationData optimizationData;
+    optimizationData.NumberOfVariables = DIM;
+    optimizationData.costFunction = [this](const Vector &x) {
+      return this->my_phi(x);
+    };
+    optimizationData.gradient = [this](const Vector &x) {
+      return this->my_phi.gradient(x);
+    };
+    optimizationData.hessian = [this](const Vector &x) {
+      return this->my_phi.hessian(x);
+    };
+    if constexpr(DIM == 2u)
+      setBounds(optimizationData, {0., 0.}, {1.0, 1.0});
+    else
+      setBounds(optimizationData, {0.0}, {1.0});
+    apsc::LinearSearchSolver solver(optimizationData, direction.clone(),
+                                    options.optimization, options.lineSearch);
+    solver.setInitialPoint(initialPoint);
+    auto [finalValues, numIter, status] = solver.solve();
+    if(status != 0 and candidate.value < finalValues.currentCostValue)
+      return {candidate.value, candidate.lambda, status, numIter};
+    return {finalValues.currentCostValue, finalValues.currentPoint, status, numIter};
+  }
+  //! The options of this solver
+  LocalSolverOptions const &
+  getOptions() const
+  {
+    return options;
   }
-  static void setLineSearchOptions(apsc::LineSearchOptions const & lso)
-		{
-	  lineSearchOptions=lso;
-		}
-  static void setOptimizationOptions(apsc::OptimizationOptions const & oop)
- 		{
- 	  optimizationOptions=oop;
- 		}
 private:
-  Eikonal::Phi<PHDIM>                     my_phi;
-  inline static apsc::LineSearchOptions   lineSearchOptions;
-  inline static apsc::OptimizationOptions optimizationOptions;
-  inline static std::unique_ptr<apsc::DescentDirectionBase>
-    descentDirectionFunction = std::make_unique<apsc::NewtonDirection>();
+  static constexpr std::size_t DIM = PHDIM - 1u;
+  //! Relative tolerance on the gradient in the optimality conditions
+  static constexpr double kktTolerance = 1.e-8;
+
+  /*!
+   * The best vertex of the base and, if it is not optimal and the base is a
+   * triangle, the best point on its edges
+   *
+   * @param optimal Set to true if the KKT conditions hold at the result
+   */
+  EikonalSolution<PHDIM>
+  lowerDimensionalMinimum(bool &optimal) const
+  {
+    std::array<Vector, DIM + 1u> vertices;
+    if constexpr(DIM == 1u)
+      vertices = {Vector{0.}, Vector{1.}};
+    else
+      vertices = {Vector{0., 0.}, Vector{1., 0.}, Vector{0., 1.}};
+
+    EikonalSolution<PHDIM> best{std::numeric_limits<double>::infinity(), vertices[0], 0};
+    for(auto const &vertex : vertices)
+      {
+        double const value = my_phi(vertex);
+        if(value < best.value)
+          best = {value, vertex, 0};
+      }
+    optimal = isOptimal(best.lambda);
+    if constexpr(DIM == 2u)
+      {
+        if(not optimal)
+          {
+            for(auto const &[a, b] : {std::pair{0u, 1u}, std::pair{0u, 2u}, std::pair{1u, 2u}})
+              {
+                auto const edge = minimizeOnSegment<PHDIM>(
+                  my_phi.simplexData.MM_Matrix, my_phi.du, vertices[a], vertices[b]);
+                if(edge.value < best.value)
+                  best = edge;
+              }
+            optimal = isOptimal(best.lambda);
+          }
+      }
+    return best;
+  }
+
+  //! KKT conditions at a point on the boundary of the base
+  bool
+  isOptimal(Vector const &lambda) const
+  {
+    Vector const g = my_phi.gradient(lambda);
+    if(not g.allFinite())
+      return false;
+    double const tol = kktTolerance * (1.0 + g.norm());
+    if constexpr(DIM == 1u)
+      {
+        return (lambda[0] == 0.0 and g[0] >= -tol) or (lambda[0] == 1.0 and g[0] <= tol);
+      }
+    else
+      {
+        constexpr double eps = 100. * std::numeric_limits<double>::epsilon();
+        bool const       on0 = lambda[0] == 0.0; // lambda_0 >= 0 active
+        bool const       on1 = lambda[1] == 0.0; // lambda_1 >= 0 active
+        bool const       on2 = std::abs(lambda[0] + lambda[1] - 1.0) <= eps;
+        // The multipliers of the active constraints must be non negative,
+        // the gradient along the free directions zero
+        if(on0 and on1)
+          return g[0] >= -tol and g[1] >= -tol;
+        if(on1 and on2)
+          return g[0] <= tol and g[1] - g[0] >= -tol;
+        if(on0 and on2)
+          return g[1] <= tol and g[0] - g[1] >= -tol;
+        if(on0)
+          return g[0] >= -tol and std::abs(g[1]) <= tol;
+        if(on1)
+          return g[1] >= -tol and std::abs(g[0]) <= tol;
+        if(on2)
+          return g[0] <= tol and std::abs(g[0] - g[1]) <= tol;
+        return false;
+      }
+  }
+
+  Eikonal::Phi<PHDIM> my_phi;
+  LocalSolverOptions  options;
 };
 #if DIMENSION==2
 extern template class solveEikonalLocalProblem<2u>;
@@ -112,11 +302,13 @@ extern template class solveEikonalLocalProblem<2u>;
  * the first three rows contain the coordinate of the base, tha last row that of the forth vertex where the solution is unknown
  * @param values The values of t at the base points
  * @param M The anisotropy matrix.
+ * @param options The options of the local solver
  * @return A structure containing the solution
  */
 EikonalSolution<2u> solveLocalProblem(std::array<std::array<double,2u>,3u> element,
 		Eigen::Matrix<double,2u,1u> values,
-         Eigen::Matrix<double,2u,2u> const & M);
+         Eigen::Matrix<double,2u,2u> const & M,
+         LocalSolverOptions const & options = LocalSolverOptions{});
 /*!
  * @brief The version of solveLocalProblem for the standard probelm where M=I (identity)
  *
@@ -133,11 +325,13 @@ extern template class solveEikonalLocalProblem<3u>;
  * the first three rows contain the coordinate of the base, tha last row that of the forth vertex where the solution is unknown
  * @param values The values of t at the base points
  * @param M The anisotropy matrix.
+ * @param options The options of the local solver
  * @return A structure containing the solution
  */
 EikonalSolution<3u> solveLocalProblem(std::array<std::array<double,3u>,4u> element,
 		 Eigen::Matrix<double,3u,1u> values,
-         Eigen::Matrix<double,3u,3u> const & M);
+         Eigen::Matrix<double,3u,3u> const & M,
+         LocalSolverOptions const & options = LocalSolverOptions{});
 /*!
  * @brief The version of solveLocalProblem for the standard probelm where M=I (identity)
  *
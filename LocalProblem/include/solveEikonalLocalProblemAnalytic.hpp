@@ -0,0 +1,203 @@
+#ifndef HH_SOLVEEIKONALANALYTIC__HH
+#define HH_SOLVEEIKONALANALYTIC__HH
+#include "Eikonal_traits.hpp"
+#include "SimplexData.hpp"
+#include "solveEikonalLocalProblem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+namespace Eikonal
+{
+/*!
+ * @brief Closed-form solver of the local eikonal problem
+ *
+ * Minimizes the same function as Phi,
+ * \f[
+ * \phi(\lambda) = \lambda_{ext}^T du + \sqrt{\lambda_{ext}^T MM \lambda_{ext}},
+ * \quad \lambda_{ext} = (\lambda, 1),
+ * \f]
+ * over the base of the simplex (\f$\lambda\in[0,1]\f$ for a triangle,
+ * \f$\lambda_i\ge 0,\ \lambda_0+\lambda_1\le 1\f$ for a tetrahedron), but
+ * without iterations. \f$\phi\f$ is convex, so
+ * - on a segment \f$\alpha t+\beta+\sqrt{Pt^2+2Qt+R}\f$ the stationary point
+ *   is \f$t=-(\alpha s+Q)/P\f$ with \f$s=\sqrt{(PR-Q^2)/(P-\alpha^2)}\f$,
+ *   clamped to [0,1];
+ * - on a triangle the stationary point is
+ *   \f$\lambda=-A^{-1}(s g+b)\f$, \f$s=\sqrt{D/(1-g^TA^{-1}g)}\f$, with
+ *   \f$A,\ b,\ R\f$ the blocks of MM, \f$g\f$ the first two entries of du
+ *   and \f$D=R-b^TA^{-1}b\f$; if it is not in the triangle the minimum is on
+ *   one of its three edges.
+ *
+ * It works with any PHDIM, it does not depend on the DIMENSION macro.
+ *
+ * @tparam PHDIM The physical dimension
+ */
+template <std::size_t PHDIM> class solveEikonalLocalProblemAnalytic
+{
+public:
+  using Vector = typename EikonalSolution<PHDIM>::Vector;
+  using VectorExt = typename Eikonal_traits<PHDIM>::VectorExt;
+  static constexpr std::size_t DIM = PHDIM - 1u;
+  //! Same arguments as solveEikonalLocalProblem
+  template <typename SIMPLEX, typename VALUES>
+  solveEikonalLocalProblemAnalytic(SIMPLEX &&simplex, VALUES &&values)
+    : simplexData{std::forward<SIMPLEX>(simplex)}
+  {
+    for(auto i = 0u; i < DIM; ++i)
+      du(i) = values(i) - values(DIM);
+    du(DIM) = values(DIM);
+  }
+  /*!
+   * Solves the local problem
+   *
+   * @return status is 0, 2 only if the data give no finite value
+   */
+  EikonalSolution<PHDIM>
+  operator()() const
+  {
+    Candidate best;
+    if constexpr(PHDIM == 2u)
+      {
+        best = onSegment(Vector{0.}, Vector{1.});
+      }
+    else
+      {
+        if(not inside(best))
+          {
+            best = onSegment(Vector{0., 0.}, Vector{1., 0.});
+            for(auto const &candidate :
+                {onSegment(Vector{0., 0.}, Vector{0., 1.}),
+                 onSegment(Vector{1., 0.}, Vector{0., 1.})})
+              {
+                if(candidate.value < best.value)
+                  best = candidate;
+              }
+          }
+      }
+    int status = std::isfinite(best.value) ? 0 : 2;
+    return {best.value, best.lambda, status};
+  }
+
+private:
+  struct Candidate
+  {
+    double value = std::numeric_limits<double>::infinity();
+    Vector lambda = Vector::Zero();
+  };
+
+  //! The minimum on the segment [la, lb] of the lambda space
+  Candidate
+  onSegment(Vector const &la, Vector const &lb) const
+  {
+    auto const segment = minimizeOnSegment<PHDIM>(simplexData.MM_Matrix, du, la, lb);
+    return {segment.value, segment.lambda};
+  }
+
+  //! The stationary point of a tetrahedron, false if not in the base triangle
+  bool
+  inside(Candidate &candidate) const
+  {
+    auto const &MM = simplexData.MM_Matrix;
+    auto const  A = MM.template topLeftCorner<DIM, DIM>();
+    auto const  b = MM.template topRightCorner<DIM, 1>();
+    Vector const g = du.template topRows<DIM>();
+    if(A.determinant() <= 0.)
+      return false;
+    // 2x2: closed-form inverse
+    auto const   Ainv = A.inverse().eval();
+    double const gAg = g.dot(Ainv * g);
+    double const D = MM(DIM, DIM) - b.dot(Ainv * b);
+    if(gAg >= 1.0 or D <= 0.)
+      return false;
+    double const s = std::sqrt(D / (1.0 - gAg));
+    Vector const lambda = -Ainv * (s * g + b);
+    if(lambda(0) < 0. or lambda(1) < 0. or lambda(0) + lambda(1) > 1.)
+      return false;
+    VectorExt lambdaExt;
+    lambdaExt.template topRows<DIM>() = lambda;
+    lambdaExt(DIM) = 1.0;
+    candidate = {lambdaExt.dot(du) + std::sqrt(lambdaExt.dot(MM * lambdaExt)), lambda};
+    return true;
+  }
+
+  SimplexData<PHDIM> simplexData;
+  VectorExt          du;
+};
+
+/*!
+ * @brief The local solvers available to the global solvers
+ */
+enum class LocalSolverType
+{
+  Newton,    //!< solveEikonalLocalProblem (projected Newton, iterative)
+  Analytic,  //!< solveEikonalLocalProblemAnalytic (closed form)
+  Batched,   //!< Closed form, all the elements of a node in one SIMD batch
+  LineSearch //!< apsc::LinearSearchSolver with a descent direction, iterative
+};
+
+//! Whether the local solver iterates from an initial lambda
+inline bool
+isIterative(LocalSolverType type)
+{
+  return type == LocalSolverType::Newton or type == LocalSolverType::LineSearch;
+}
+
+//! Default local solver, Analytic if EIKONAL_ANALYTIC_LOCAL_SOLVER is defined
+#ifdef EIKONAL_ANALYTIC_LOCAL_SOLVER
+inline constexpr LocalSolverType defaultLocalSolver = LocalSolverType::Analytic;
+#else
+inline constexpr LocalSolverType defaultLocalSolver = LocalSolverType::Newton;
+#endif
+
+/*!
+ * @brief Solve a local problem, starting the iterative solvers from a given
+ * point
+ *
+ * The iterative solvers start from initialLambda (a warm start); the
+ * closed-form solvers ignore it. LineSearch uses apsc::NewtonDirection, the
+ * other descent directions are available through LocalSolverEngine.
+ *
+ * @param type The local solver
+ * @param simplex The simplex, the unknown is at the last vertex
+ * @param values The values of u at the base vertices
+ * @param initialLambda The starting point of the iterations
+ * @param options The options of the iterative solvers
+ */
+template <std::size_t PHDIM>
+EikonalSolution<PHDIM>
+solveLocalProblem(LocalSolverType type, SimplexData<PHDIM> const &simplex,
+                  typename Eikonal_traits<PHDIM>::VectorExt const &values,
+                  typename EikonalSolution<PHDIM>::Vector const &initialLambda,
+                  LocalSolverOptions const &options = LocalSolverOptions{})
+{
+  switch(type)
+    {
+    case LocalSolverType::Newton:
+      return solveEikonalLocalProblem<PHDIM>{simplex, values, options}(initialLambda);
+    case LocalSolverType::LineSearch:
+      return solveEikonalLocalProblem<PHDIM>{simplex, values, options}(
+        initialLambda, apsc::NewtonDirection{});
+    default:
+      // A single simplex is not worth a batch
+      return solveEikonalLocalProblemAnalytic<PHDIM>{simplex, values}();
+    }
+}
+
+/*!
+ * @brief Solve a local problem with the chosen local solver
+ *
+ * Same as the other version, the iterative solvers start from the centre
+ * of the base.
+ */
+template <std::size_t PHDIM>
+EikonalSolution<PHDIM>
+solveLocalProblem(LocalSolverType type, SimplexData<PHDIM> const &simplex,
+                  typename Eikonal_traits<PHDIM>::VectorExt const &values)
+{
+  typename EikonalSolution<PHDIM>::Vector initialLambda;
+  initialLambda.fill(0.333);
+  return solveLocalProblem(type, simplex, values, initialLambda);
+}
+
+} // namespace Eikonal
+#endif
@@ -25,6 +25,8 @@ using Values = std::array<double, PHDIM>;
 using Solution = Eikonal::EikonalSolution<PHDIM>;
 using Lambda = apsc::LineSearch_traits_base<PHDIM - 1u>::Vector;
 using Solver = Eikonal::solveEikonalLocalProblem<PHDIM>;
+//! The options used by the solves of the module
+static Eikonal::LocalSolverOptions options;
 /*!
  * @brief Binding module to python
  */
@@ -62,18 +64,26 @@ PYBIND11_MODULE(MODULENAME, m)
     .def_readwrite("status", &Solution::status,"Status: 0 means ok");
 
   m.def("setLineSearchOptions", [](LineSearchOptions const &opt) {
-    Solver::setLineSearchOptions(opt);
+    options.lineSearch = opt;
   },"Sets line search options");
 
   m.def("setOptimizationOptions", [](OptimizationOptions const &opt) {
-    Solver::setOptimizationOptions(opt);
+    options.optimization = opt;
   },"Sets general optimization options");
 
-  m.def("solveLocalProblem", &Eikonal::solveLocalProblem,
+  m.def("solveLocalProblem",
+        [](Element element, Eigen::Matrix<double, PHDIM, 1> values,
+           Matrix const &M) {
+          return Eikonal::solveLocalProblem(element, values, M, options);
+        },
         "A function that solves the local Eikonal problem", py::arg("element"),
         py::arg("values"), py::arg("M"));
 
-  m.def("solveLocalProblemIsotropic", &Eikonal::solveLocalProblemIsotropic,
+  m.def("solveLocalProblemIsotropic",
+        [](Element element, Eigen::Matrix<double, PHDIM, 1> values) {
+          return Eikonal::solveLocalProblem(element, values, Matrix::Identity(),
+                                            options);
+        },
         "A function that solves the local Eikonal problem (isotropic)",
         py::arg("element"), py::arg("values"));
 }
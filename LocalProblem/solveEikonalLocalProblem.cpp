@@ -22,13 +22,15 @@ namespace Eikonal
             is the one where we have to compute u
     @param values. An Eigen vector containing the values of u at the base of the tiangle/tetra
     @param M A positive definite matrix (as an Eigen Matrix) the contains the information of the wave celerity
+    @param options The options of the local solver
    */
  EikonalSolution<PHDIM> solveLocalProblem(std::array<std::array<double,PHDIM>,PHDIM+1u> element,
 		 Eigen::Matrix<double,PHDIM,1>values,
-         Eigen::Matrix<double,PHDIM,PHDIM> const & M)
+         Eigen::Matrix<double,PHDIM,PHDIM> const & M,
+         LocalSolverOptions const & options)
  {
 	 Eikonal::SimplexData<PHDIM> simplex{element,M};
-	 Eikonal::solveEikonalLocalProblem<PHDIM> solver{std::move(simplex),std::move(values)};
+	 Eikonal::solveEikonalLocalProblem<PHDIM> solver{std::move(simplex),std::move(values),options};
 	 return solver();
  }
   /*!
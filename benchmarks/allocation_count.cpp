@@ -0,0 +1,206 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <omp.h>
+#include "EikonalSolver.hpp"
+#include "ParallelEikonalSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Counts the heap allocations made by a full update() and updateAsync() of
+ * the solvers, with every local solver and parallel granularity, a
+ * line-search engine chosen by name and the adaptive tolerances. The global
+ * operator new is replaced by a counting one; only the updates are
+ * measured, construction is allowed to allocate.
+ *
+ * usage: allocation_count [mesh.vtk]
+ *
+ * Exits with 1 if an update allocates. The LineSearch engines are reported
+ * but not checked: apsc::LinearSearchSolver works on dynamic vectors.
+ */
+
+namespace
+{
+std::atomic<long> allocations{0};
+
+// The replacement operators below allocate and free only through these two,
+// out of line, so that the compiler does not pair the malloc of one
+// operator with the free of another (-Wmismatched-new-delete)
+__attribute__((noinline)) void *acquire(std::size_t size, std::size_t align)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = align > alignof(std::max_align_t) ? std::aligned_alloc(align, (size + align - 1) / align * align)
+                                                  : std::malloc(size > 0 ? size : 1);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+__attribute__((noinline)) void release(void *ptr) { std::free(ptr); }
+} // namespace
+
+void *operator new(std::size_t size) { return acquire(size, 0); }
+void *operator new[](std::size_t size) { return acquire(size, 0); }
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return acquire(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return acquire(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept { release(ptr); }
+void operator delete[](void *ptr) noexcept { release(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { release(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { release(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { release(ptr); }
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+
+// Allocations made by f()
+template <typename F>
+long countAllocations(F &&f)
+{
+    const long before = allocations.load();
+    f();
+    return allocations.load() - before;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty())
+    {
+        std::cerr << "Empty mesh" << std::endl;
+        return 1;
+    }
+    mesh.nodes[mesh.nodes.size() / 2]->isSource = true;
+
+    Mat M_matrix = Mat::Identity();
+
+    // Let the OpenMP runtime set up its thread pool before measuring
+#pragma omp parallel
+    {
+    }
+
+    const std::vector<std::pair<std::string, Eikonal::LocalSolverType>> local_solvers = {
+        {"Newton", Eikonal::LocalSolverType::Newton},
+        {"Analytic", Eikonal::LocalSolverType::Analytic},
+        {"Batched", Eikonal::LocalSolverType::Batched}};
+    const std::vector<std::pair<std::string, ParallelGranularity>> policies = {
+        {"Nodes", ParallelGranularity::Nodes},
+        {"Elements", ParallelGranularity::Elements},
+        {"Hybrid", ParallelGranularity::Hybrid}};
+
+    bool allocation_free = true;
+    auto report = [&](const std::string &name, long count, bool checked = true)
+    {
+        std::cout << std::left << std::setw(44) << name << count << (checked || count == 0 ? "" : " (not checked)")
+                  << "\n";
+        allocation_free = allocation_free && (!checked || count == 0);
+    };
+
+    std::cout << "Mesh: " << mesh_path << ", threads: " << omp_get_max_threads() << "\n\n";
+    std::cout << std::left << std::setw(44) << "Engine" << "allocations\n";
+    for (const auto &[solver_name, type] : local_solvers)
+    {
+        {
+            EikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+            solver.setLocalSolver(type);
+            report("EikonalSolver::update / " + solver_name, countAllocations([&] { solver.update(); }));
+        }
+        for (const auto &[policy_name, policy] : policies)
+        {
+            ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix, policy);
+            solver.setLocalSolver(type);
+            report("update / " + policy_name + " / " + solver_name, countAllocations([&] { solver.update(); }));
+        }
+        {
+            ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+            solver.setLocalSolver(type);
+            report("updateAsync / " + solver_name, countAllocations([&] { solver.updateAsync(); }));
+        }
+    }
+
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver(Eikonal::LocalSolverType::Newton);
+        solver.setWarmStart(true);
+        report("update / Newton warm start", countAllocations([&] { solver.update(); }));
+    }
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setSolutionCache(true);
+        report("update / solution cache", countAllocations([&] { solver.update(); }));
+    }
+    {
+        EikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver("LineSearch/BFGS");
+        report("EikonalSolver::update / LineSearch/BFGS", countAllocations([&] { solver.update(); }), false);
+    }
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver("LineSearch/BFGS");
+        report("update / LineSearch/BFGS", countAllocations([&] { solver.update(); }), false);
+    }
+    {
+        EikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver(Eikonal::LocalSolverType::Newton);
+        solver.setToleranceSchedule(true);
+        report("EikonalSolver::update / tolerance schedule", countAllocations([&] { solver.update(); }));
+    }
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver(Eikonal::LocalSolverType::Newton);
+        solver.setToleranceSchedule(true);
+        report("update / tolerance schedule", countAllocations([&] { solver.update(); }));
+        ParallelEikonalSolver<PHDIM> async(mesh.mesh_elements, M_matrix);
+        async.setLocalSolver(Eikonal::LocalSolverType::Newton);
+        async.setToleranceSchedule(true);
+        report("updateAsync / tolerance schedule", countAllocations([&] { async.updateAsync(); }));
+    }
+
+    {
+        // Pins the threads: measured last
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setNumaMode(true);
+        report("update / NUMA mode", countAllocations([&] { solver.update(); }));
+        ParallelEikonalSolver<PHDIM> async(mesh.mesh_elements, M_matrix);
+        async.setNumaMode(true);
+        report("updateAsync / NUMA mode", countAllocations([&] { async.updateAsync(); }));
+    }
+
+    std::cout << "\n" << (allocation_free ? "The updates do not allocate" : "An update allocates") << std::endl;
+    return allocation_free ? 0 : 1;
+}
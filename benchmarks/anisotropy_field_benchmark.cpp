@@ -0,0 +1,184 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include "ParallelEikonalSolver.hpp"
+#include "PointToPointSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Solves from the first node id with an anisotropy field (a tensor per
+ * element) against one matrix for the whole mesh:
+ * - a field equal everywhere to an anisotropic M, with each local solver:
+ *   the values must be those of M within the convergence tolerance of the
+ *   solvers (10 EPSILON), since the order of the parallel updates depends
+ *   on the scheduling of the threads;
+ * - two layers, the half of the mesh with the smaller x three times slower
+ *   (M = 9 I) than the other (M = I): the values must lie between those of
+ *   the uniform M = I and M = 9 I, and a goal-directed query to the farthest
+ *   node must give the value of the full solve. The difference reported is
+ *   the one with M = I, for the layers, and with the full solve, for the
+ *   query.
+ *
+ * usage: anisotropy_field_benchmark [mesh.vtk] [repetitions]
+ *
+ * Exits with 1 if a check fails.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Geometry = Eikonal::MeshGeometry<PHDIM>;
+using Field = std::vector<Eikonal::Tensor<PHDIM>>;
+using Clock = std::chrono::steady_clock;
+
+struct Run
+{
+    double seconds = 0.0;
+    Eikonal::NodeValues values;
+};
+
+Run solve(const std::shared_ptr<const Geometry> &geometry, Eikonal::LocalSolverType type, int repetitions)
+{
+    Run run;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        ParallelEikonalSolver<PHDIM> solver(geometry, {0});
+        solver.setLocalSolver(type);
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        run.seconds += duration.count() / repetitions;
+        run.values = solver.getValues();
+    }
+    return run;
+}
+
+double maxDifference(const Eikonal::NodeValues &a, const Eikonal::NodeValues &b)
+{
+    double max_diff = 0.0;
+    for (std::size_t id = 0; id < a.size(); ++id)
+    {
+        if (a[id] < INF || b[id] < INF)
+        {
+            max_diff = std::max(max_diff, std::abs(a[id] - b[id]));
+        }
+    }
+    return max_diff;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty())
+    {
+        std::cerr << "Empty mesh" << std::endl;
+        return 1;
+    }
+    const std::size_t num_elements = mesh.mesh_elements.size();
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, " << num_elements
+              << " elements)\n\n";
+    std::cout << std::left << std::setw(24) << "Case" << std::setw(14) << "time [ms]" << "difference\n";
+    auto report = [](const std::string &name, double seconds, double max_diff)
+    {
+        std::cout << std::left << std::setw(24) << name << std::setw(14) << seconds * 1e3 << max_diff << "\n";
+    };
+
+    bool ok = true;
+
+    // The same anisotropic M as one matrix and as a field
+    Mat M = Mat::Identity();
+    M(0, 0) = 4.0;
+    M(0, 1) = M(1, 0) = 0.5;
+    const auto uniform = std::make_shared<const Geometry>(mesh.mesh_elements, M);
+    const auto same = std::make_shared<const Geometry>(mesh.mesh_elements,
+                                                       Field(num_elements, Eikonal::compactTensor<PHDIM>(M)));
+    const std::pair<const char *, Eikonal::LocalSolverType> solvers[] = {
+        {"analytic", Eikonal::LocalSolverType::Analytic},
+        {"batched", Eikonal::LocalSolverType::Batched},
+        {"newton", Eikonal::LocalSolverType::Newton}};
+    for (const auto &[name, type] : solvers)
+    {
+        const Run reference = solve(uniform, type, repetitions);
+        const Run field = solve(same, type, repetitions);
+        const double max_diff = maxDifference(field.values, reference.values);
+        report(std::string(name) + ", matrix", reference.seconds, 0.0);
+        report(std::string(name) + ", field", field.seconds, max_diff);
+        ok = ok && max_diff <= 10 * EPSILON;
+    }
+
+    // Two layers, split at the middle of the x extent
+    double lower = mesh.nodes.front()->p[0], upper = lower;
+    for (const auto &node : mesh.nodes)
+    {
+        lower = std::min(lower, node->p[0]);
+        upper = std::max(upper, node->p[0]);
+    }
+    const Eikonal::Tensor<PHDIM> fast = Eikonal::compactTensor<PHDIM>(Mat::Identity());
+    const Eikonal::Tensor<PHDIM> slow = Eikonal::compactTensor<PHDIM>(9.0 * Mat::Identity());
+    Field layers(num_elements);
+    for (std::size_t e = 0; e < num_elements; ++e)
+    {
+        double centroid = 0.0;
+        for (const auto &vertex : mesh.mesh_elements[e].vertex)
+        {
+            centroid += vertex->p[0] / (PHDIM + 1);
+        }
+        layers[e] = centroid < (lower + upper) / 2 ? slow : fast;
+    }
+    const auto layered = std::make_shared<const Geometry>(mesh.mesh_elements, std::move(layers));
+    const Run low = solve(std::make_shared<const Geometry>(mesh.mesh_elements, Mat::Identity()),
+                          Eikonal::LocalSolverType::Batched, 1);
+    const Run high = solve(std::make_shared<const Geometry>(mesh.mesh_elements, Mat(9.0 * Mat::Identity())),
+                           Eikonal::LocalSolverType::Batched, 1);
+    const Run two = solve(layered, Eikonal::LocalSolverType::Batched, repetitions);
+    report("layers, batched", two.seconds, maxDifference(two.values, low.values));
+    std::size_t farthest = 0;
+    for (std::size_t id = 0; id < two.values.size(); ++id)
+    {
+        if (two.values[id] < INF)
+        {
+            ok = ok && two.values[id] >= low.values[id] - 1e-9 && two.values[id] <= high.values[id] + 1e-9;
+            farthest = two.values[id] > two.values[farthest] ? id : farthest;
+        }
+    }
+
+    PointToPointSolver<PHDIM> queries(layered);
+    auto start = Clock::now();
+    const double time = queries.query(0, static_cast<unsigned int>(farthest)).time;
+    std::chrono::duration<double> duration = Clock::now() - start;
+    report("layers, query", duration.count(), std::abs(time - two.values[farthest]));
+    ok = ok && std::abs(time - two.values[farthest]) <= 10 * EPSILON;
+
+    if (!ok)
+    {
+        std::cerr << "A field equal to M differs from M, a layered value is outside the uniform bounds, or the "
+                     "query differs from the full solve"
+                  << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+#include "ParallelEikonalSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Times a solve from the first node id with each stopping criterion against
+ * a full solve:
+ * - a travel time cutoff at a quarter of the largest travel time;
+ * - three targets, the nodes closest to a fifth of the largest travel time;
+ * - a region of interest, the half of the bounding box (per axis) on the side
+ *   of the source.
+ *
+ * usage: early_termination_benchmark [mesh.vtk] [repetitions]
+ *
+ * Exits with 1 if a value kept differs from the full solve, or if a target
+ * is left unreached. In the region the values are those of paths inside it:
+ * they may only be larger, near its boundary.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
+using Geometry = Eikonal::MeshGeometry<PHDIM>;
+using Solver = ParallelEikonalSolver<PHDIM>;
+using Criteria = Eikonal::StoppingCriteria<PHDIM>;
+using Clock = std::chrono::steady_clock;
+
+struct Run
+{
+    double seconds = 0.0;
+    std::size_t localSolves = 0;
+    std::size_t reached = 0;
+    Eikonal::NodeValues values;
+};
+
+Run solve(const std::shared_ptr<const Geometry> &geometry, const Criteria *criteria, int repetitions)
+{
+    Run run;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        Solver solver(geometry, {0});
+        if (criteria)
+        {
+            solver.setStoppingCriteria(*criteria);
+        }
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        run.seconds += duration.count() / repetitions;
+        run.localSolves = solver.getStatistics().localSolves;
+        run.values = solver.getValues();
+        run.reached = 0;
+        for (std::size_t id = 0; id < run.values.size(); ++id)
+        {
+            run.reached += geometry->hasNode(id) && solver.isReached(id);
+        }
+    }
+    return run;
+}
+
+// Largest difference with the reference over the nodes reached
+double maxDifference(const Run &run, const Eikonal::NodeValues &reference)
+{
+    double max_diff = 0.0;
+    for (std::size_t id = 0; id < run.values.size(); ++id)
+    {
+        if (run.values[id] < INF)
+        {
+            max_diff = std::max(max_diff, std::abs(run.values[id] - reference[id]));
+        }
+    }
+    return max_diff;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty())
+    {
+        std::cerr << "Empty mesh" << std::endl;
+        return 1;
+    }
+
+    Mat M_matrix = Mat::Identity();
+    auto geometry = std::make_shared<const Geometry>(mesh.mesh_elements, M_matrix);
+    const Run full = solve(geometry, nullptr, repetitions);
+    double largest = 0.0;
+    for (std::size_t id = 0; id < full.values.size(); ++id)
+    {
+        if (full.values[id] < INF)
+        {
+            largest = std::max(largest, full.values[id]);
+        }
+    }
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n";
+    std::cout << "Threads: " << omp_get_max_threads() << "\n\n";
+    std::cout << std::left << std::setw(12) << "Criterion" << std::setw(14) << "time [ms]" << std::setw(16)
+              << "local solves" << std::setw(16) << "nodes reached" << "difference\n";
+
+    bool ok = true;
+    auto report = [&](const std::string &name, const Run &run, double max_diff)
+    {
+        std::cout << std::left << std::setw(12) << name << std::setw(14) << run.seconds * 1e3 << std::setw(16)
+                  << run.localSolves << std::setw(16) << run.reached << max_diff << "\n";
+    };
+    report("none", full, 0.0);
+
+    Criteria cutoff;
+    cutoff.maxTime = largest / 4;
+    const Run by_time = solve(geometry, &cutoff, repetitions);
+    report("time", by_time, maxDifference(by_time, full.values));
+    ok = ok && maxDifference(by_time, full.values) < 1e-6;
+
+    Criteria targets;
+    std::vector<unsigned int> ids;
+    for (std::size_t id = 0; id < full.values.size(); ++id)
+    {
+        if (geometry->hasNode(id) && full.values[id] < INF)
+        {
+            ids.push_back(static_cast<unsigned int>(id));
+        }
+    }
+    const std::size_t num_targets = std::min<std::size_t>(3, ids.size());
+    std::partial_sort(ids.begin(), ids.begin() + num_targets, ids.end(), [&](unsigned int a, unsigned int b)
+                      { return std::abs(full.values[a] - largest / 5) < std::abs(full.values[b] - largest / 5); });
+    targets.targets.assign(ids.begin(), ids.begin() + num_targets);
+    const Run by_targets = solve(geometry, &targets, repetitions);
+    report("targets", by_targets, maxDifference(by_targets, full.values));
+    ok = ok && maxDifference(by_targets, full.values) < 1e-6;
+    for (auto id : targets.targets)
+    {
+        ok = ok && by_targets.values[id] < INF;
+    }
+
+    // The half of the bounding box on the side of the source
+    Point lower = geometry->point(0), upper = geometry->point(0);
+    for (std::size_t id = 0; id < geometry->numNodes(); ++id)
+    {
+        if (geometry->hasNode(id))
+        {
+            lower = lower.cwiseMin(geometry->point(id));
+            upper = upper.cwiseMax(geometry->point(id));
+        }
+    }
+    Point region_lower, region_upper;
+    for (unsigned int i = 0; i < PHDIM; ++i)
+    {
+        const double half = (upper[i] - lower[i]) / 2;
+        const bool low_side = geometry->point(0)[i] - lower[i] <= upper[i] - geometry->point(0)[i];
+        region_lower[i] = low_side ? lower[i] : upper[i] - half;
+        region_upper[i] = low_side ? lower[i] + half : upper[i];
+    }
+    Criteria region;
+    region.setRegion(region_lower, region_upper);
+    const Run by_region = solve(geometry, &region, repetitions);
+
+    report("region", by_region, maxDifference(by_region, full.values));
+    for (std::size_t id = 0; id < by_region.values.size(); ++id)
+    {
+        ok = ok && by_region.values[id] >= full.values[id] - 1e-6;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "A value differs from the full solve, a target was not reached, or a value in the region is "
+                     "smaller than the full solve"
+                  << std::endl;
+        return 1;
+    }
+    return 0;
+}
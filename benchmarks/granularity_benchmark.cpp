@@ -0,0 +1,154 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+#include "ParallelEikonalSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Times ParallelEikonalSolver::update() under each ParallelGranularity, and
+ * compares the values with those of the serial EikonalSolver.
+ *
+ * usage: granularity_benchmark [mesh.vtk] [repetitions]
+ *
+ * Before the policy existed every local solve opened its own parallel region
+ * from inside the parallel sweep; the first figure printed estimates the
+ * cost of such a region, paid once per solved node and now gone with every
+ * policy. It is measured on an empty nested region, not on the old
+ * solveLocal(), which no longer exists.
+ *
+ * Exits with 1 if a policy differs from the serial solver by more than the
+ * convergence tolerance of the solvers (10 EPSILON).
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Clock = std::chrono::steady_clock;
+
+// Wall time of an inner parallel region opened from a parallel loop, as
+// solveLocal() used to do for every node of the frontier.
+double regionOverhead(int repetitions)
+{
+    double sink = 0.0;
+    auto start = Clock::now();
+#pragma omp parallel for schedule(dynamic) reduction(+ : sink)
+    for (int i = 0; i < repetitions; ++i)
+    {
+        double inner = 0.0;
+#pragma omp parallel reduction(+ : inner)
+        {
+            inner += 1.0;
+        }
+        sink += inner;
+    }
+    std::chrono::duration<double> duration = Clock::now() - start;
+    if (sink < 0.0)
+    {
+        std::cout << sink;
+    }
+    return duration.count() / repetitions;
+}
+
+struct Run
+{
+    double seconds = 0.0;
+    Eikonal::NodeValues values;
+};
+
+Run timeUpdate(Mesh<PHDIM> &mesh, Mat &M_matrix, ParallelGranularity policy, int repetitions)
+{
+    Run run;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        // The constructor resets the values, only update() is timed
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix, policy);
+        auto start = Clock::now();
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        run.seconds += duration.count() / repetitions;
+        run.values = solver.getValues();
+    }
+    return run;
+}
+
+double maxDifference(const Eikonal::NodeValues &a, const Eikonal::NodeValues &b)
+{
+    double max_diff = 0.0;
+    for (std::size_t id = 0; id < a.size(); ++id)
+    {
+        if (a[id] < INF || b[id] < INF)
+        {
+            max_diff = std::max(max_diff, std::abs(a[id] - b[id]));
+        }
+    }
+    return max_diff;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty())
+    {
+        std::cerr << "Empty mesh" << std::endl;
+        return 1;
+    }
+    mesh.nodes[mesh.nodes.size() / 2]->isSource = true;
+
+    Mat M_matrix = Mat::Identity();
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n";
+    std::cout << "Threads: " << omp_get_max_threads() << "\n";
+    std::cout << "Parallel region overhead per local solve (old nested scheme, empty region): "
+              << regionOverhead(10000) * 1e6 << " us\n\n";
+
+    const std::vector<std::pair<std::string, ParallelGranularity>> policies = {
+        {"Nodes", ParallelGranularity::Nodes},
+        {"Elements", ParallelGranularity::Elements},
+        {"Hybrid", ParallelGranularity::Hybrid}};
+
+    EikonalSolver<PHDIM> serial(mesh.mesh_elements, M_matrix);
+    serial.update();
+    const Eikonal::NodeValues reference = serial.getValues();
+
+    bool ok = true;
+    std::cout << std::left << std::setw(12) << "Policy" << std::setw(16) << "update() [ms]" << "difference\n";
+    for (const auto &[name, policy] : policies)
+    {
+        const Run run = timeUpdate(mesh, M_matrix, policy, repetitions);
+        const double max_diff = maxDifference(run.values, reference);
+        std::cout << std::left << std::setw(12) << name << std::setw(16) << run.seconds * 1e3 << max_diff << "\n";
+        ok = ok && max_diff <= 10 * EPSILON;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "A policy differs from the serial solver" << std::endl;
+        return 1;
+    }
+    return 0;
+}
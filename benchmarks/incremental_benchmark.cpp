@@ -0,0 +1,167 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+#include "ParallelEikonalSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Compares an incremental re-solve (ParallelEikonalSolver::applyChanges)
+ * with a solve from scratch after three changes of a converged solve from
+ * two sources, the first and the last node id:
+ * - a source added in the middle of the ids;
+ * - the last source moved to a neighbour;
+ * - the speed of the elements around a node changed (the same speed here,
+ *   on a new geometry), which resets the region downstream of them.
+ *
+ * usage: incremental_benchmark [mesh.vtk] [repetitions]
+ *
+ * Exits with 1 if an incremental result differs from the one from scratch.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Geometry = Eikonal::MeshGeometry<PHDIM>;
+using Solver = ParallelEikonalSolver<PHDIM>;
+using Clock = std::chrono::steady_clock;
+
+struct Run
+{
+    double seconds = 0.0;
+    std::size_t localSolves = 0;
+    Eikonal::NodeValues values;
+};
+
+// A solve from scratch from the given sources
+Run fromScratch(const std::shared_ptr<const Geometry> &geometry, const std::vector<unsigned int> &sources,
+                int repetitions)
+{
+    Run run;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        Solver solver(geometry, sources);
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        run.seconds += duration.count() / repetitions;
+        run.localSolves = solver.getStatistics().localSolves;
+        run.values = solver.getValues();
+    }
+    return run;
+}
+
+// The previous solve continued after the changes
+Run incremental(const std::shared_ptr<const Geometry> &geometry, const Solver &previous,
+                const Eikonal::ChangeSet &changes, int repetitions)
+{
+    Run run;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        Solver solver(geometry, previous.getState(), changes);
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        run.seconds += duration.count() / repetitions;
+        run.localSolves = solver.getStatistics().localSolves;
+        run.values = solver.getValues();
+    }
+    return run;
+}
+
+double maxDifference(const Eikonal::NodeValues &a, const Eikonal::NodeValues &b)
+{
+    double max_diff = 0.0;
+    for (std::size_t id = 0; id < a.size(); ++id)
+    {
+        max_diff = std::max(max_diff, std::abs(a[id] - b[id]));
+    }
+    return max_diff;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.size() < 3)
+    {
+        std::cerr << "The mesh needs at least three nodes" << std::endl;
+        return 1;
+    }
+
+    Mat M_matrix = Mat::Identity();
+    auto geometry = std::make_shared<const Geometry>(mesh.mesh_elements, M_matrix);
+    const unsigned int first = 0;
+    const unsigned int last = static_cast<unsigned int>(mesh.nodes.size() - 1);
+    const unsigned int middle = last / 2;
+
+    Solver previous(geometry, {first, last});
+    previous.update();
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n";
+    std::cout << "Threads: " << omp_get_max_threads() << "\n\n";
+    std::cout << std::left << std::setw(20) << "Change" << std::setw(16) << "scratch [ms]" << std::setw(18)
+              << "incremental [ms]" << std::setw(16) << "scratch solves" << std::setw(20)
+              << "incremental solves" << "difference\n";
+
+    bool ok = true;
+    auto report = [&](const std::string &name, const std::shared_ptr<const Geometry> &changed_geometry,
+                      const std::vector<unsigned int> &sources, const Eikonal::ChangeSet &changes)
+    {
+        const Run scratch = fromScratch(changed_geometry, sources, repetitions);
+        const Run fast = incremental(changed_geometry, previous, changes, repetitions);
+        const double max_diff = maxDifference(scratch.values, fast.values);
+        ok = ok && max_diff < 1e-6;
+        std::cout << std::left << std::setw(20) << name << std::setw(16) << scratch.seconds * 1e3 << std::setw(18)
+                  << fast.seconds * 1e3 << std::setw(16) << scratch.localSolves << std::setw(20)
+                  << fast.localSolves << max_diff << "\n";
+    };
+
+    Eikonal::ChangeSet added;
+    added.addedSources = {middle};
+    report("add source", geometry, {first, last, middle}, added);
+
+    const unsigned int moved = *geometry->getAdjacency().neighboursOf(last).begin();
+    Eikonal::ChangeSet move;
+    move.removedSources = {last};
+    move.addedSources = {moved};
+    report("move source", geometry, {first, moved}, move);
+
+    auto new_geometry = std::make_shared<const Geometry>(mesh.mesh_elements, M_matrix);
+    Eikonal::ChangeSet speed;
+    for (auto e : geometry->getAdjacency().elementsOf(middle))
+    {
+        speed.changedElements.push_back(e);
+    }
+    report("change speed", new_geometry, {first, last}, speed);
+
+    if (!ok)
+    {
+        std::cerr << "An incremental re-solve differs from the solve from scratch" << std::endl;
+        return 1;
+    }
+    return 0;
+}
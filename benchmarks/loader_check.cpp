@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Loads a legacy VTK file with every kind of data section loadMesh has to
+ * read or skip (tests/mesh3D_sections.vtk: VECTORS, NORMALS,
+ * TEXTURE_COORDINATES, COLOR_SCALARS, SCALARS with a LOOKUP_TABLE, a FIELD
+ * of CELL_DATA and METADATA blocks) and checks what it read:
+ * - 107 nodes and 231 elements, as in tests/mesh3D.vtk;
+ * - POINT_DATA: only the SCALARS "temperature", id / 10 at node id;
+ * - CELL_DATA: only the FIELD arrays "region", id % 2 at element id, and
+ *   "quality", 0.5 everywhere.
+ *
+ * usage: loader_check [mesh_sections.vtk]
+ *
+ * Exits with 1 if the file does not load or a check fails.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+#else
+constexpr unsigned int PHDIM = 3;
+#endif
+
+using Array = Mesh<PHDIM>::DataArray;
+
+int failures = 0;
+
+void check(bool condition, const std::string &what)
+{
+    std::cout << (condition ? "ok      " : "FAILED  ") << what << "\n";
+    failures += !condition;
+}
+
+// Whether the array has size values of one component, value(id) at every id
+template <typename Value>
+bool holds(const Array &array, std::size_t size, const Value &value)
+{
+    if (array.components != 1 || array.values.size() != size)
+    {
+        return false;
+    }
+    for (std::size_t id = 0; id < size; ++id)
+    {
+        if (std::abs(array.values[id] - value(id)) > 1e-12)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : "../tests/mesh3D_sections.vtk";
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::size_t num_nodes = 107;
+    const std::size_t num_elements = 231;
+    std::cout << "Mesh: " << mesh_path << "\n";
+    check(mesh.nodes.size() == num_nodes, "107 nodes");
+    check(mesh.mesh_elements.size() == num_elements, "231 elements");
+
+    check(mesh.pointData.size() == 1, "one POINT_DATA array");
+    const auto temperature = mesh.pointData.find("temperature");
+    check(temperature != mesh.pointData.end() &&
+              holds(temperature->second, num_nodes, [](std::size_t id) { return id / 10.0; }),
+          "temperature: id / 10 at every node");
+
+    check(mesh.cellData.size() == 2, "two CELL_DATA arrays");
+    const auto region = mesh.cellData.find("region");
+    check(region != mesh.cellData.end() &&
+              holds(region->second, num_elements, [](std::size_t id) { return static_cast<double>(id % 2); }),
+          "region: id % 2 at every element");
+    const auto quality = mesh.cellData.find("quality");
+    check(quality != mesh.cellData.end() &&
+              holds(quality->second, num_elements, [](std::size_t) { return 0.5; }),
+          "quality: 0.5 at every element");
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include "BatchedLocalSolver.hpp"
+#include "LocalSolverEngine.hpp"
+#include "ParallelEikonalSolver.hpp"
+#include "solveEikonalLocalProblemAnalytic.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Compares the local solvers (Eikonal::LocalSolverType) on the local problems
+ * of a mesh, then times a full solve with each of them. Finally times every
+ * engine of Eikonal::LocalSolverEngineFactory and recommends the fastest one
+ * within the accuracy target.
+ *
+ * usage: local_solver_benchmark [mesh.vtk] [repetitions] [tolerance]
+ *
+ * The local problems are those of every (element, vertex) pair, with the
+ * values of a converged solution at the base vertices.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
+using VectorExt = typename Eikonal::Eikonal_traits<PHDIM>::VectorExt;
+using Clock = std::chrono::steady_clock;
+
+using LocalProblem = Eikonal::LocalProblemData<PHDIM>;
+
+std::vector<LocalProblem> collectProblems(const Mesh<PHDIM> &mesh, const Mat &M_matrix)
+{
+    std::vector<LocalProblem> problems;
+    for (const auto &element : mesh.mesh_elements)
+    {
+        for (unsigned int k = 0; k <= PHDIM; ++k)
+        {
+            std::array<Point, PHDIM + 1> points;
+            VectorExt values;
+            unsigned int count = 0;
+            for (unsigned int j = 0; j <= PHDIM; ++j)
+            {
+                if (j != k)
+                {
+                    points[count] = element.vertex[j]->p;
+                    values[count] = element.vertex[j]->u;
+                    ++count;
+                }
+            }
+            points[PHDIM] = element.vertex[k]->p;
+            problems.push_back({Eikonal::SimplexData<PHDIM>{points, M_matrix}, values});
+        }
+    }
+    return problems;
+}
+
+// Time per local solve, and the values found
+double timeLocal(const std::vector<LocalProblem> &problems, const Mat &M_matrix, Eikonal::LocalSolverType type,
+                 int repetitions, std::vector<double> &values)
+{
+    values.assign(problems.size(), 0.0);
+    Eikonal::simd::LocalProblemBatch<PHDIM> batch;
+    auto start = Clock::now();
+    for (int r = 0; r < repetitions; ++r)
+    {
+        if (type == Eikonal::LocalSolverType::Batched)
+        {
+            // Batches of consecutive problems, as the solvers do with the elements of a node
+            for (std::size_t first = 0; first < problems.size(); first += batch.capacity)
+            {
+                batch.clear();
+                for (std::size_t i = first; i < problems.size() && !batch.full(); ++i)
+                {
+                    batch.add(problems[i].simplex.points, problems[i].values);
+                }
+                Eikonal::simd::solveBatch(batch, M_matrix);
+                std::copy(batch.result, batch.result + batch.size, values.begin() + first);
+            }
+            continue;
+        }
+        for (std::size_t i = 0; i < problems.size(); ++i)
+        {
+            values[i] = Eikonal::solveLocalProblem(type, problems[i].simplex, problems[i].values).value;
+        }
+    }
+    std::chrono::duration<double> duration = Clock::now() - start;
+    return duration.count() / (repetitions * problems.size());
+}
+
+double timeUpdate(Mesh<PHDIM> &mesh, Mat &M_matrix, Eikonal::LocalSolverType type, int repetitions,
+                  Eikonal::SolverStatistics &statistics)
+{
+    double total = 0.0;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver(type);
+        auto start = Clock::now();
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        total += duration.count();
+        statistics = solver.getStatistics();
+    }
+    return total / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+    const double tolerance = argc > 3 ? std::stod(argv[3]) : 1e-6;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty())
+    {
+        std::cerr << "Empty mesh" << std::endl;
+        return 1;
+    }
+    mesh.nodes[mesh.nodes.size() / 2]->isSource = true;
+
+    Mat M_matrix = Mat::Identity();
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n\n";
+
+    // Local problems with the values of a converged solution
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.update();
+    }
+    const std::vector<LocalProblem> problems = collectProblems(mesh, M_matrix);
+
+    const std::vector<std::pair<std::string, Eikonal::LocalSolverType>> solvers = {
+        {"Newton", Eikonal::LocalSolverType::Newton},
+        {"Analytic", Eikonal::LocalSolverType::Analytic},
+        {"Batched", Eikonal::LocalSolverType::Batched}};
+
+    std::cout << std::left << std::setw(12) << "Solver" << std::setw(18) << "update() [ms]"
+              << "local solve [us]\n";
+    std::vector<double> reference;
+    std::vector<double> values;
+    std::vector<Eikonal::SolverStatistics> statistics(solvers.size());
+    double max_difference = 0.0;
+    std::size_t s = 0;
+    for (const auto &[name, type] : solvers)
+    {
+        const double update_time = timeUpdate(mesh, M_matrix, type, repetitions, statistics[s++]);
+        const double local_time = timeLocal(problems, M_matrix, type, repetitions, values);
+        if (reference.empty())
+        {
+            reference = values;
+        }
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            max_difference = std::max(max_difference, std::abs(values[i] - reference[i]));
+        }
+        std::cout << std::left << std::setw(12) << name << std::setw(18) << update_time * 1e3
+                  << local_time * 1e6 << "\n";
+    }
+    std::cout << "\nLargest difference between local solutions: " << max_difference << "\n";
+    std::cout << "Batched kernel: " << Eikonal::simd::isaName(Eikonal::simd::bestIsa()) << "\n";
+    std::cout << "\nLocal problems of one update():\n";
+    for (std::size_t i = 0; i < solvers.size(); ++i)
+    {
+        std::cout << std::left << std::setw(14) << solvers[i].first << statistics[i] << "\n";
+    }
+
+    // Newton warm-started from the lambdas of the previous solves
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver(Eikonal::LocalSolverType::Newton);
+        solver.setWarmStart(true);
+        solver.update();
+        std::cout << std::left << std::setw(14) << "Newton+warm" << solver.getStatistics() << "\n";
+    }
+    // Newton with the cache of the local solutions
+    {
+        ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+        solver.setLocalSolver(Eikonal::LocalSolverType::Newton);
+        solver.setSolutionCache(true);
+        solver.update();
+        std::cout << std::left << std::setw(14) << "Newton+cache" << solver.getStatistics() << "\n";
+    }
+
+    // Every engine of the factory, the closed form being the reference
+    std::cout << "\nEngines (accuracy target " << tolerance << "):\n";
+    std::cout << std::left << std::setw(22) << "Engine" << std::setw(18) << "local solve [us]"
+              << "max error\n";
+    const auto engines = Eikonal::benchmarkLocalSolverEngines<PHDIM>(problems, M_matrix, tolerance, repetitions);
+    for (const auto &engine : engines)
+    {
+        std::cout << std::left << std::setw(22) << engine.name << std::setw(18) << engine.time * 1e6
+                  << engine.maxError << (engine.accurate ? "" : " (inaccurate)") << "\n";
+    }
+    std::cout << "Recommended engine: " << Eikonal::recommendLocalSolverEngine(engines) << "\n";
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+#include "MultiSourceEikonalSolver.hpp"
+#include "ParallelEikonalSolver.hpp"
+#include "Mesh.hpp"
+#include "VTKWriter.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Compares K independent solves with ParallelEikonalSolver (closed-form
+ * local solver, batched) with one MultiSourceEikonalSolver solve from the
+ * same K sources, and prints the time per source of both.
+ *
+ * usage: multi_source_benchmark [mesh.vtk] [K] [repetitions] [output.vtk]
+ *
+ * The sources are K nodes evenly spaced in id. With an output file the K
+ * solutions are written to it, one SCALARS field per source.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Geometry = Eikonal::MeshGeometry<PHDIM>;
+using Clock = std::chrono::steady_clock;
+
+// Seconds for K single-source solves; values[k] are the solutions
+double timeIndependent(const std::shared_ptr<const Geometry> &geometry, const std::vector<unsigned int> &sources,
+                       int repetitions, std::vector<std::vector<double>> &values)
+{
+    double total = 0.0;
+    values.resize(sources.size());
+    for (int r = 0; r < repetitions; ++r)
+    {
+        for (std::size_t k = 0; k < sources.size(); ++k)
+        {
+            auto start = Clock::now();
+            ParallelEikonalSolver<PHDIM> solver(geometry, {sources[k]});
+            solver.setLocalSolver(Eikonal::LocalSolverType::Batched);
+            solver.update();
+            std::chrono::duration<double> duration = Clock::now() - start;
+            total += duration.count();
+            values[k].assign(solver.getValues().begin(), solver.getValues().end());
+        }
+    }
+    return total / repetitions;
+}
+
+// Seconds for one K-source solve; values[k] are the solutions
+double timeMultiSource(const std::shared_ptr<const Geometry> &geometry, const std::vector<unsigned int> &sources,
+                       int repetitions, std::vector<std::vector<double>> &values)
+{
+    double total = 0.0;
+    values.resize(sources.size());
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        MultiSourceEikonalSolver<PHDIM> solver(geometry, sources);
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        total += duration.count();
+        for (std::size_t k = 0; k < sources.size(); ++k)
+        {
+            values[k] = solver.getValues(k);
+        }
+    }
+    return total / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const std::size_t K = argc > 2 ? std::stoul(argv[2]) : 16;
+    const int repetitions = argc > 3 ? std::stoi(argv[3]) : 5;
+    const std::string output = argc > 4 ? argv[4] : "";
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty() || K == 0)
+    {
+        std::cerr << "Empty mesh or no sources" << std::endl;
+        return 1;
+    }
+
+    Mat M_matrix = Mat::Identity();
+    auto geometry = std::make_shared<const Geometry>(mesh.mesh_elements, M_matrix);
+    std::vector<unsigned int> sources;
+    for (std::size_t k = 0; k < K; ++k)
+    {
+        sources.push_back(static_cast<unsigned int>(k * mesh.nodes.size() / K));
+    }
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n";
+    std::cout << "Threads: " << omp_get_max_threads() << ", sources: " << K << "\n\n";
+
+    std::vector<std::vector<double>> independent, batched;
+    const double t_independent = timeIndependent(geometry, sources, repetitions, independent);
+    const double t_batched = timeMultiSource(geometry, sources, repetitions, batched);
+
+    double max_diff = 0.0;
+    for (std::size_t k = 0; k < K; ++k)
+    {
+        for (std::size_t id = 0; id < independent[k].size(); ++id)
+        {
+            max_diff = std::max(max_diff, std::abs(independent[k][id] - batched[k][id]));
+        }
+    }
+
+    std::cout << std::left << std::setw(24) << "Solve" << "per source [ms]\n";
+    std::cout << std::left << std::setw(24) << "K independent" << t_independent / K * 1e3 << "\n";
+    std::cout << std::left << std::setw(24) << "multi-source" << t_batched / K * 1e3 << "\n";
+    std::cout << "\nSpeedup: " << t_independent / t_batched << ", largest difference: " << max_diff << "\n";
+
+    if (!output.empty())
+    {
+        std::vector<VTKWriter<PHDIM>::Field> fields;
+        for (std::size_t k = 0; k < K; ++k)
+        {
+            fields.push_back({"source_" + std::to_string(sources[k]), batched[k]});
+        }
+        try
+        {
+            VTKWriter<PHDIM>::write(output, mesh, fields);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << "Error writing VTK file: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
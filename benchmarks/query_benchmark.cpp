@@ -0,0 +1,126 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "ParallelEikonalSolver.hpp"
+#include "PointToPointSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Compares the point-to-point queries (PointToPointSolver) with a full solve
+ * from the source, on random pairs of nodes (fixed seed):
+ * - the average latency, local solves and nodes expanded;
+ * - the largest difference of the travel time with the full solve.
+ *
+ * usage: query_benchmark [mesh.vtk] [pairs]
+ *
+ * Exits with 1 if a query differs from the full solve by
+ * more than the convergence tolerance of the solvers (10 EPSILON).
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Geometry = Eikonal::MeshGeometry<PHDIM>;
+using Clock = std::chrono::steady_clock;
+
+struct Totals
+{
+    double seconds = 0.0;
+    std::size_t localSolves = 0;
+    std::size_t visited = 0;
+    double maxDiff = 0.0;
+};
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int num_pairs = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty() || num_pairs < 1)
+    {
+        std::cerr << "Empty mesh or no pairs" << std::endl;
+        return 1;
+    }
+
+    Mat M_matrix = Mat::Identity();
+    auto geometry = std::make_shared<const Geometry>(mesh.mesh_elements, M_matrix);
+    std::vector<unsigned int> ids;
+    for (std::size_t id = 0; id < geometry->numNodes(); ++id)
+    {
+        if (geometry->hasNode(id))
+        {
+            ids.push_back(static_cast<unsigned int>(id));
+        }
+    }
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+
+    PointToPointSolver<PHDIM> queries(geometry);
+    Totals full, goal;
+    for (int pair = 0; pair < num_pairs; ++pair)
+    {
+        const unsigned int source = ids[pick(generator)];
+        const unsigned int target = ids[pick(generator)];
+
+        auto start = Clock::now();
+        ParallelEikonalSolver<PHDIM> solver(geometry, {source});
+        solver.update();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        const double reference = solver.getValues()[target];
+        full.seconds += duration.count();
+        full.localSolves += solver.getStatistics().localSolves;
+        full.visited += ids.size();
+
+        queries.resetStatistics();
+        start = Clock::now();
+        const auto result = queries.query(source, target);
+        duration = Clock::now() - start;
+        goal.seconds += duration.count();
+        goal.localSolves += queries.getStatistics().localSolves;
+        goal.visited += result.visited.size();
+        goal.maxDiff = std::max(goal.maxDiff, std::abs(result.time - reference));
+    }
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n";
+    std::cout << "Pairs: " << num_pairs << "\n\n";
+    std::cout << std::left << std::setw(16) << "Mode" << std::setw(16) << "latency [ms]" << std::setw(16)
+              << "local solves" << std::setw(16) << "nodes visited" << "difference\n";
+    auto report = [&](const std::string &name, const Totals &totals)
+    {
+        std::cout << std::left << std::setw(16) << name << std::setw(16) << totals.seconds * 1e3 / num_pairs
+                  << std::setw(16) << totals.localSolves / num_pairs << std::setw(16) << totals.visited / num_pairs
+                  << totals.maxDiff << "\n";
+    };
+    report("full solve", full);
+    report("goal-directed", goal);
+
+    if (goal.maxDiff > 10 * EPSILON)
+    {
+        std::cerr << "A query differs from the full solve" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "ParallelEikonalSolver.hpp"
+#include "Mesh.hpp"
+#include "loadMesh.hpp"
+
+/*
+ * Geodesic Voronoi regions of K sources with different start times (source
+ * k, a random node, starts at time k): one solve from all the sources with
+ * labels (getSourceLabels) against K solves, one per source, and a per-node
+ * min reduction of value + start time.
+ *
+ * usage: voronoi_benchmark [mesh.vtk] [K] [repetitions]
+ *
+ * Reports the time of both, the largest difference of the values and the
+ * fraction of the nodes labelled differently. They are not the same
+ * discrete problem: where two regions meet, the solve from all the sources
+ * interpolates between the values of two sources in an element, which lowers
+ * the values there and downstream, by up to an element on coarse meshes.
+ * Exits with 1 if more than a tenth of the nodes are labelled differently.
+ */
+
+#if DIMENSION == 2
+constexpr unsigned int PHDIM = 2;
+const std::string default_mesh = "../tests/mesh2D.vtk";
+#else
+constexpr unsigned int PHDIM = 3;
+const std::string default_mesh = "../tests/mesh3D.vtk";
+#endif
+
+using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+using Geometry = Eikonal::MeshGeometry<PHDIM>;
+using Solver = ParallelEikonalSolver<PHDIM>;
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char **argv)
+{
+    const std::string mesh_path = argc > 1 ? argv[1] : default_mesh;
+    const int num_sources = argc > 2 ? std::stoi(argv[2]) : 4;
+    const int repetitions = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    Mesh<PHDIM> mesh;
+    try
+    {
+        loadMesh<PHDIM>::init_Mesh(mesh_path, mesh);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Error loading mesh: " << e.what() << std::endl;
+        return 1;
+    }
+    if (mesh.nodes.empty() || num_sources < 1)
+    {
+        std::cerr << "Empty mesh or no sources" << std::endl;
+        return 1;
+    }
+
+    Mat M_matrix = Mat::Identity();
+    auto geometry = std::make_shared<const Geometry>(mesh.mesh_elements, M_matrix);
+    std::vector<unsigned int> ids;
+    for (std::size_t id = 0; id < geometry->numNodes(); ++id)
+    {
+        if (geometry->hasNode(id))
+        {
+            ids.push_back(static_cast<unsigned int>(id));
+        }
+    }
+    std::mt19937 generator(7);
+    std::shuffle(ids.begin(), ids.end(), generator);
+    Eikonal::BoundaryConditions boundary;
+    for (int k = 0; k < num_sources && k < static_cast<int>(ids.size()); ++k)
+    {
+        boundary.add(ids[k], static_cast<double>(k), k);
+    }
+
+    // One solve from all the sources
+    double labelled_seconds = 0.0;
+    Eikonal::NodeValues values;
+    std::vector<int> labels;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        Solver solver(geometry, boundary);
+        solver.update();
+        labels = solver.getSourceLabels();
+        std::chrono::duration<double> duration = Clock::now() - start;
+        labelled_seconds += duration.count() / repetitions;
+        values = solver.getValues();
+    }
+
+    // K solves and a min reduction
+    double separate_seconds = 0.0;
+    std::vector<double> nearest;
+    std::vector<int> nearest_label;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        nearest.assign(geometry->numNodes(), INF);
+        nearest_label.assign(geometry->numNodes(), -1);
+        for (const auto &source : boundary.values)
+        {
+            Solver solver(geometry, {source.node});
+            solver.update();
+            const auto &u = solver.getValues();
+            for (std::size_t id = 0; id < u.size(); ++id)
+            {
+                if (u[id] + source.time < nearest[id])
+                {
+                    nearest[id] = u[id] + source.time;
+                    nearest_label[id] = source.label;
+                }
+            }
+        }
+        std::chrono::duration<double> duration = Clock::now() - start;
+        separate_seconds += duration.count() / repetitions;
+    }
+
+    double max_diff = 0.0;
+    std::size_t mismatches = 0;
+    for (auto id : ids)
+    {
+        max_diff = std::max(max_diff, std::abs(values[id] - nearest[id]));
+        mismatches += labels[id] != nearest_label[id];
+    }
+    const double mismatch_fraction = static_cast<double>(mismatches) / ids.size();
+
+    std::cout << "Mesh: " << mesh_path << " (" << mesh.nodes.size() << " nodes, "
+              << mesh.mesh_elements.size() << " elements)\n";
+    std::cout << "Sources: " << boundary.values.size() << "\n\n";
+    std::cout << std::left << std::setw(28) << "one labelled solve [ms]" << labelled_seconds * 1e3 << "\n"
+              << std::setw(28) << "K solves + min [ms]" << separate_seconds * 1e3 << "\n"
+              << std::setw(28) << "value difference" << max_diff << "\n"
+              << std::setw(28) << "labels differing" << mismatches << " (" << mismatch_fraction * 100 << "%)\n";
+
+    if (mismatch_fraction > 0.1)
+    {
+        std::cerr << "The labels differ from the nearest source on too many nodes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+#ifndef ANISOTROPYFIELD_HPP
+#define ANISOTROPYFIELD_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Eikonal_traits.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief The anisotropy of one element, a symmetric matrix stored by its
+ * independent entries only: xx yy xy in 2D, xx yy zz xy yz xz in 3D (the
+ * order of the VTK TENSORS6 arrays).
+ *
+ * 24 or 48 bytes per element instead of 32 or 72, read by the batched local
+ * solver straight from a contiguous array indexed by element.
+ */
+template <unsigned int PHDIM>
+using Tensor = std::array<double, PHDIM * (PHDIM + 1) / 2>;
+
+/**
+ * @brief The compact entries of a matrix, of its symmetric part if it is
+ * not symmetric (the travel time sqrt(d^T M d) only depends on that).
+ */
+template <unsigned int PHDIM>
+Tensor<PHDIM> compactTensor(const typename Eikonal_traits<PHDIM>::MMatrix &M) {
+  if constexpr (PHDIM == 2) {
+    return {M(0, 0), M(1, 1), 0.5 * (M(0, 1) + M(1, 0))};
+  } else {
+    return {M(0, 0),
+            M(1, 1),
+            M(2, 2),
+            0.5 * (M(0, 1) + M(1, 0)),
+            0.5 * (M(1, 2) + M(2, 1)),
+            0.5 * (M(0, 2) + M(2, 0))};
+  }
+}
+
+/**
+ * @brief The full matrix of compact entries.
+ */
+template <unsigned int PHDIM>
+typename Eikonal_traits<PHDIM>::MMatrix
+expandTensor(const Tensor<PHDIM> &t) {
+  typename Eikonal_traits<PHDIM>::MMatrix M;
+  if constexpr (PHDIM == 2) {
+    M << t[0], t[2], t[2], t[1];
+  } else {
+    M << t[0], t[3], t[5], t[3], t[1], t[4], t[5], t[4], t[2];
+  }
+  return M;
+}
+
+/**
+ * @brief The tensors of a CELL_DATA array of the input file (see
+ * Mesh::cellData), one per element.
+ *
+ * An element has either the compact entries (3 or 6 components, as above)
+ * or the full matrix by rows (4 or 9 components). The VTK TENSORS and
+ * TENSORS6 arrays are always 3D: for a 2D mesh their z entries are ignored.
+ * A full matrix that is not symmetric counts by its symmetric part.
+ *
+ * @param components The components per element.
+ * @throw std::invalid_argument If the number of components is none of
+ * those.
+ */
+template <unsigned int PHDIM>
+std::vector<Tensor<PHDIM>> anisotropyFieldOf(const std::vector<double> &values,
+                                             unsigned int components) {
+  // Where the compact entries are in an element, by the components
+  std::array<unsigned int, PHDIM * (PHDIM + 1) / 2> at;
+  if constexpr (PHDIM == 2) {
+    switch (components) {
+    case 3:
+      at = {0, 1, 2};
+      break;
+    case 4:
+      at = {0, 3, 1};
+      break;
+    case 6:
+      at = {0, 1, 3};
+      break;
+    case 9:
+      at = {0, 4, 1};
+      break;
+    default:
+      components = 0;
+    }
+  } else {
+    switch (components) {
+    case 6:
+      at = {0, 1, 2, 3, 4, 5};
+      break;
+    case 9:
+      at = {0, 4, 8, 1, 5, 2};
+      break;
+    default:
+      components = 0;
+    }
+  }
+  if (components == 0) {
+    throw std::invalid_argument(
+        "An anisotropy field needs " + std::to_string(at.size()) + " or " +
+        std::to_string(PHDIM * PHDIM) + " components per element");
+  }
+  const bool full = components == 9 || (PHDIM == 2 && components == 4);
+  const unsigned int rows = components == 9 ? 3 : 2;
+  const std::size_t count = values.size() / components;
+  std::vector<Tensor<PHDIM>> field(count);
+  for (std::size_t e = 0; e < count; ++e) {
+    const double *v = values.data() + e * components;
+    for (std::size_t i = 0; i < at.size(); ++i) {
+      field[e][i] = v[at[i]];
+    }
+    if (full) {
+      // The mean of the two off-diagonal entries: the symmetric part
+      field[e][PHDIM] = 0.5 * (v[1] + v[rows]);
+      if constexpr (PHDIM == 3) {
+        field[e][4] = 0.5 * (v[5] + v[7]);
+        field[e][5] = 0.5 * (v[2] + v[6]);
+      }
+    }
+  }
+  return field;
+}
+
+} // namespace Eikonal
+
+#endif // ANISOTROPYFIELD_HPP
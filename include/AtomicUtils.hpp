@@ -0,0 +1,97 @@
+#ifndef ATOMICUTILS_HPP
+#define ATOMICUTILS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Lock-free primitives shared by the parallel engines.
+ *
+ * The node values live in plain doubles (Node<PHDIM>::u), so the updates go
+ * through the GCC/Clang __atomic builtins instead of std::atomic<double>.
+ */
+namespace Eikonal {
+
+/**
+ * @brief Atomically read a shared value.
+ */
+inline double atomicLoad(const double &target) {
+  double value;
+  __atomic_load(&target, &value, __ATOMIC_ACQUIRE);
+  return value;
+}
+
+/**
+ * @brief Atomically write a shared value.
+ */
+inline void atomicStore(double &target, double value) {
+  __atomic_store(&target, &value, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Atomically lower a shared value, never raise it.
+ *
+ * Compare-and-swap loop on the bits of the double: the store only happens if
+ * nobody changed the value since it was read, so a smaller value written by
+ * another thread is never overwritten by a larger one.
+ *
+ * @param target The shared value.
+ * @param value The candidate value.
+ * @return true if target has been lowered to value.
+ */
+inline bool atomicMin(double &target, double value) {
+  double current = atomicLoad(target);
+  while (value < current) {
+    if (__atomic_compare_exchange(&target, &current, &value, true,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief One atomic test-and-set flag per node id.
+ *
+ * Used to mark the nodes that are already active (enqueued), so that a node
+ * is activated exactly once however many threads try to activate it.
+ */
+class NodeFlags {
+public:
+  NodeFlags() = default;
+
+  explicit NodeFlags(std::size_t size) { resize(size); }
+
+  /**
+   * @brief Reallocate the flags, all cleared.
+   */
+  void resize(std::size_t size) {
+    flags = std::make_unique<std::atomic<bool>[]>(size);
+    count = size;
+    for (std::size_t i = 0; i < count; ++i) {
+      flags[i].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  std::size_t size() const { return count; }
+
+  /**
+   * @brief Set the flag.
+   *
+   * @return true if the flag was clear, i.e. the caller won the activation.
+   */
+  bool testAndSet(std::size_t id) { return !flags[id].exchange(true); }
+
+  void clear(std::size_t id) { flags[id].store(false); }
+
+  bool test(std::size_t id) const { return flags[id].load(); }
+
+private:
+  std::unique_ptr<std::atomic<bool>[]> flags;
+  std::size_t count = 0;
+};
+
+} // namespace Eikonal
+
+#endif // ATOMICUTILS_HPP
@@ -0,0 +1,386 @@
+#ifndef BATCHEDLOCALSOLVER_HPP
+#define BATCHEDLOCALSOLVER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "AnisotropyField.hpp"
+#include "Eikonal_traits.hpp"
+
+/**
+ * @brief Closed-form local solves of many simplices at once.
+ *
+ * The same minimization as solveEikonalLocalProblemAnalytic, but for a batch
+ * of (node, element) candidates stored in SoA layout: every lane goes
+ * through the same branch-free sequence of operations, the candidates
+ * (interior point, edges) being selected with masks, so the lane loop is
+ * vectorized. The kernel is compiled for AVX-512, AVX2 and the baseline ISA,
+ * and the best one the cpu supports is picked at run time.
+ */
+namespace Eikonal::simd {
+
+/**
+ * @brief Instruction sets the batched kernel is compiled for.
+ */
+enum class Isa { Scalar, AVX2, AVX512 };
+
+inline const char *isaName(Isa isa) {
+  switch (isa) {
+  case Isa::AVX512:
+    return "AVX-512";
+  case Isa::AVX2:
+    return "AVX2";
+  default:
+    return "scalar";
+  }
+}
+
+/**
+ * @brief The widest instruction set supported by the cpu.
+ */
+inline Isa detectIsa() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return Isa::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return Isa::AVX2;
+  }
+#endif
+  return Isa::Scalar;
+}
+
+inline Isa bestIsa() {
+  static const Isa isa = detectIsa();
+  return isa;
+}
+
+/**
+ * @brief A batch of local problems in SoA layout.
+ *
+ * Lane k holds the base vertices point[0..PHDIM-1] with their values and the
+ * vertex point[PHDIM] where the solution is computed. The problems of a
+ * batch share the anisotropy given to solveBatch(), or each one has its own
+ * in metric, when they are all added with it (an anisotropy field).
+ */
+template <std::size_t PHDIM> struct LocalProblemBatch {
+  static constexpr std::size_t capacity = 64;
+  //! Entries of a compact anisotropy, see Eikonal::Tensor.
+  static constexpr std::size_t numEntries = PHDIM * (PHDIM + 1) / 2;
+
+  alignas(64) double point[PHDIM + 1][PHDIM][capacity];
+  alignas(64) double value[PHDIM][capacity];
+  alignas(64) double metric[numEntries][capacity];
+  alignas(64) double result[capacity];
+  std::size_t size = 0;
+  //! Whether the problems were added with their own anisotropy.
+  bool perLane = false;
+
+  bool full() const { return size == capacity; }
+
+  void clear() {
+    size = 0;
+    perLane = false;
+  }
+
+  /**
+   * @brief Append a problem, the base vertices first.
+   */
+  template <typename Points, typename Values>
+  void add(const Points &points, const Values &values) {
+    for (std::size_t v = 0; v <= PHDIM; ++v) {
+      for (std::size_t i = 0; i < PHDIM; ++i) {
+        point[v][i][size] = points[v][i];
+      }
+    }
+    for (std::size_t v = 0; v < PHDIM; ++v) {
+      value[v][size] = values[v];
+    }
+    ++size;
+  }
+
+  /**
+   * @brief Append a problem with its own anisotropy, in compact form; the
+   * other problems of the batch must have theirs too.
+   */
+  template <typename Points, typename Values, typename Metric>
+  void add(const Points &points, const Values &values, const Metric &tensor) {
+    for (std::size_t i = 0; i < numEntries; ++i) {
+      metric[i][size] = tensor[i];
+    }
+    perLane = true;
+    add(points, values);
+  }
+
+  /**
+   * @brief Smallest result of the batch, empty if there is none.
+   */
+  double minResult(double empty) const {
+    double min_value = empty;
+    for (std::size_t k = 0; k < size; ++k) {
+      min_value = std::min(min_value, result[k]);
+    }
+    return min_value;
+  }
+};
+
+namespace detail {
+
+// The kernels are optimized also in unoptimized builds. sqrt is vectorized
+// only with -fno-math-errno (set by CMakeLists.txt): with errno it is a call.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("O3", "no-trapping-math")
+#endif
+
+// std::max and std::min as plain selects, inlined also in unoptimized builds
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline double
+maxOf(double a, double b) {
+  return (a < b) ? b : a;
+}
+
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline double
+minOf(double a, double b) {
+  return (b < a) ? b : a;
+}
+
+/**
+ * @brief Minimum of alpha t + beta + sqrt(P t^2 + 2 Q t + R) on [0, 1].
+ */
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline double
+segmentMin(double P, double Q, double R, double alpha, double beta) {
+  const double phi0 = beta + std::sqrt(maxOf(R, 0.0));
+  const double phi1 = alpha + beta + std::sqrt(maxOf(P + 2.0 * Q + R, 0.0));
+  // Stationary point, meaningful only if P > alpha^2. Every lane computes it,
+  // with the denominators kept positive.
+  constexpr double tiny = std::numeric_limits<double>::min();
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  const double denom = P - alpha * alpha;
+  const bool interior = denom > 0.0;
+  const double s = std::sqrt(maxOf(P * R - Q * Q, 0.0) / maxOf(denom, tiny));
+  const double t = minOf(maxOf(-(alpha * s + Q) / maxOf(P, tiny), 0.0), 1.0);
+  const double phit =
+      alpha * t + beta + std::sqrt(maxOf(P * t * t + 2.0 * Q * t + R, 0.0));
+  return minOf(minOf(phi0, phi1), interior ? phit : inf);
+}
+
+/**
+ * @brief x^T M y for the symmetric M of compact entries m (see
+ * Eikonal::Tensor).
+ */
+template <std::size_t PHDIM, std::size_t N>
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline double
+bilinear(const double (&x)[PHDIM], const double (&m)[N],
+         const double (&y)[PHDIM]) {
+  // Written out: the lane loop must not contain inner loops to be vectorized
+  if constexpr (PHDIM == 2) {
+    return x[0] * (m[0] * y[0] + m[2] * y[1]) +
+           x[1] * (m[2] * y[0] + m[1] * y[1]);
+  } else {
+    return x[0] * (m[0] * y[0] + m[3] * y[1] + m[5] * y[2]) +
+           x[1] * (m[3] * y[0] + m[1] * y[1] + m[4] * y[2]) +
+           x[2] * (m[5] * y[0] + m[4] * y[1] + m[2] * y[2]);
+  }
+}
+
+/**
+ * @brief The compact anisotropy of lane k: its own, or the shared one.
+ */
+template <std::size_t PHDIM, bool PerLane>
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline void
+metricOf(const LocalProblemBatch<PHDIM> &batch, const double *shared,
+         std::size_t k, double (&m)[LocalProblemBatch<PHDIM>::numEntries]) {
+  m[0] = PerLane ? batch.metric[0][k] : shared[0];
+  m[1] = PerLane ? batch.metric[1][k] : shared[1];
+  m[2] = PerLane ? batch.metric[2][k] : shared[2];
+  if constexpr (PHDIM == 3) {
+    m[3] = PerLane ? batch.metric[3][k] : shared[3];
+    m[4] = PerLane ? batch.metric[4][k] : shared[4];
+    m[5] = PerLane ? batch.metric[5][k] : shared[5];
+  }
+}
+
+/**
+ * @brief Coordinates of point[to] - point[from] in lane k.
+ */
+template <std::size_t PHDIM>
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline void
+edge(const LocalProblemBatch<PHDIM> &batch, std::size_t from, std::size_t to,
+     std::size_t k, double (&e)[PHDIM]) {
+  e[0] = batch.point[to][0][k] - batch.point[from][0][k];
+  e[1] = batch.point[to][1][k] - batch.point[from][1][k];
+  if constexpr (PHDIM == 3) {
+    e[2] = batch.point[to][2][k] - batch.point[from][2][k];
+  }
+}
+
+/**
+ * @brief The kernel, instantiated once per instruction set and per source of
+ * the anisotropy.
+ *
+ * @tparam PerLane Whether every lane has its own anisotropy (batch.metric).
+ * @param M The compact anisotropy of all the lanes, if not PerLane.
+ */
+template <std::size_t PHDIM, bool PerLane>
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline void
+batchKernel(LocalProblemBatch<PHDIM> &batch, const double *M) {
+  static_assert(PHDIM == 2 || PHDIM == 3, "Only triangles and tetrahedra");
+  const std::size_t n = batch.size;
+#pragma omp simd
+  for (std::size_t k = 0; k < n; ++k) {
+    double m[LocalProblemBatch<PHDIM>::numEntries];
+    metricOf<PHDIM, PerLane>(batch, M, k, m);
+    if constexpr (PHDIM == 2) {
+      // Edges as in SimplexData, MM = E^T M E
+      double e0[2], e1[2];
+      edge(batch, 0, 1, k, e0);
+      edge(batch, 1, 2, k, e1);
+      const double MM00 = bilinear(e0, m, e0);
+      const double MM01 = bilinear(e0, m, e1);
+      const double MM11 = bilinear(e1, m, e1);
+      const double du0 = batch.value[0][k] - batch.value[1][k];
+      const double du1 = batch.value[1][k];
+      batch.result[k] = segmentMin(MM00, MM01, MM11, du0, du1);
+    } else {
+      double e0[3], e1[3], e2[3];
+      edge(batch, 0, 2, k, e0);
+      edge(batch, 1, 2, k, e1);
+      edge(batch, 2, 3, k, e2);
+      const double MM00 = bilinear(e0, m, e0);
+      const double MM01 = bilinear(e0, m, e1);
+      const double MM02 = bilinear(e0, m, e2);
+      const double MM11 = bilinear(e1, m, e1);
+      const double MM12 = bilinear(e1, m, e2);
+      const double MM22 = bilinear(e2, m, e2);
+      const double du0 = batch.value[0][k] - batch.value[2][k];
+      const double du1 = batch.value[1][k] - batch.value[2][k];
+      const double du2 = batch.value[2][k];
+
+      // Interior stationary point (see solveEikonalLocalProblemAnalytic)
+      constexpr double tiny = std::numeric_limits<double>::min();
+      const double det = MM00 * MM11 - MM01 * MM01;
+      const bool invertible = det > 0.0;
+      const double inv_det = 1.0 / maxOf(det, tiny);
+      const double Ai00 = MM11 * inv_det;
+      const double Ai01 = -MM01 * inv_det;
+      const double Ai11 = MM00 * inv_det;
+      const double Aig0 = Ai00 * du0 + Ai01 * du1;
+      const double Aig1 = Ai01 * du0 + Ai11 * du1;
+      const double Aib0 = Ai00 * MM02 + Ai01 * MM12;
+      const double Aib1 = Ai01 * MM02 + Ai11 * MM12;
+      const double gAg = du0 * Aig0 + du1 * Aig1;
+      const double D = MM22 - (MM02 * Aib0 + MM12 * Aib1);
+      // Non-short-circuit &: the comparisons are evaluated in every lane
+      const bool causal = invertible & (gAg < 1.0) & (D > 0.0);
+      const double s = std::sqrt(maxOf(D, 0.0) / maxOf(1.0 - gAg, tiny));
+      const double l0 = -(s * Aig0 + Aib0);
+      const double l1 = -(s * Aig1 + Aib1);
+      const bool inside =
+          causal & (l0 >= 0.0) & (l1 >= 0.0) & (l0 + l1 <= 1.0);
+      const double q = l0 * (MM00 * l0 + MM01 * l1 + MM02) +
+                       l1 * (MM01 * l0 + MM11 * l1 + MM12) +
+                       (MM02 * l0 + MM12 * l1 + MM22);
+      const double interior =
+          l0 * du0 + l1 * du1 + du2 + std::sqrt(maxOf(q, 0.0));
+
+      // The three edges of the base: lambda1 = 0, lambda0 = 0,
+      // lambda0 + lambda1 = 1
+      const double edge0 = segmentMin(MM00, MM02, MM22, du0, du2);
+      const double edge1 = segmentMin(MM11, MM12, MM22, du1, du2);
+      const double edge2 =
+          segmentMin(MM00 - 2.0 * MM01 + MM11, MM01 - MM00 + MM12 - MM02,
+                     MM00 + 2.0 * MM02 + MM22, du1 - du0, du0 + du2);
+      const double boundary = minOf(minOf(edge0, edge1), edge2);
+      batch.result[k] = inside ? interior : boundary;
+    }
+  }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+template <std::size_t PHDIM, bool PerLane>
+__attribute__((target("avx512f"))) void
+batchKernelAVX512(LocalProblemBatch<PHDIM> &batch, const double *M) {
+  batchKernel<PHDIM, PerLane>(batch, M);
+}
+
+template <std::size_t PHDIM, bool PerLane>
+__attribute__((target("avx2"))) void
+batchKernelAVX2(LocalProblemBatch<PHDIM> &batch, const double *M) {
+  batchKernel<PHDIM, PerLane>(batch, M);
+}
+#endif
+
+template <std::size_t PHDIM, bool PerLane>
+void batchKernelScalar(LocalProblemBatch<PHDIM> &batch, const double *M) {
+  batchKernel<PHDIM, PerLane>(batch, M);
+}
+
+template <std::size_t PHDIM, bool PerLane>
+void dispatchKernel(LocalProblemBatch<PHDIM> &batch, const double *M,
+                    Isa isa) {
+  switch (isa) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  case Isa::AVX512:
+    batchKernelAVX512<PHDIM, PerLane>(batch, M);
+    break;
+  case Isa::AVX2:
+    batchKernelAVX2<PHDIM, PerLane>(batch, M);
+    break;
+#endif
+  default:
+    batchKernelScalar<PHDIM, PerLane>(batch, M);
+  }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+} // namespace detail
+
+/**
+ * @brief Solve all the problems of a batch, results in batch.result.
+ *
+ * @param M The anisotropy matrix of the problems added without their own.
+ * @param isa The instruction set, by default the best one available.
+ */
+template <std::size_t PHDIM>
+void solveBatch(LocalProblemBatch<PHDIM> &batch,
+                const typename Eikonal_traits<PHDIM>::AnisotropyM &M,
+                Isa isa = bestIsa()) {
+  if (batch.perLane) {
+    detail::dispatchKernel<PHDIM, true>(batch, nullptr, isa);
+  } else {
+    const auto shared = compactTensor<PHDIM>(M);
+    detail::dispatchKernel<PHDIM, false>(batch, shared.data(), isa);
+  }
+}
+
+} // namespace Eikonal::simd
+
+#endif // BATCHEDLOCALSOLVER_HPP
@@ -0,0 +1,102 @@
+#ifndef BOUNDARYCONDITIONS_HPP
+#define BOUNDARYCONDITIONS_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Eikonal_traits.hpp"
+#include "MeshGeometry.hpp"
+#include "PointLocator.hpp"
+#include "SolveState.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief The sources of a solve with their starting times, g(x) on the nodes
+ * given; a node given twice keeps the smallest time.
+ *
+ * A type of its own rather than a vector, so that the solver constructors
+ * taking it are not ambiguous with those taking the ids of the sources.
+ */
+struct BoundaryConditions {
+  BoundaryConditions() = default;
+  BoundaryConditions(std::initializer_list<BoundaryValue> values)
+      : values(values) {}
+
+  void add(unsigned int node, double time, int label = -1) {
+    values.push_back({node, time, label});
+  }
+
+  void add(const BoundaryConditions &other) {
+    values.insert(values.end(), other.values.begin(), other.values.end());
+  }
+
+  std::vector<BoundaryValue> values;
+};
+
+/**
+ * @brief The boundary values of a field of the nodes, e.g. a POINT_DATA
+ * array of the input file (Mesh::pointData): every node with a value not
+ * negative is a source starting at that time; a negative value marks a
+ * node that is not.
+ *
+ * @param labels The label of every node, e.g. another POINT_DATA array, or
+ * empty for sources without a label.
+ * @throw std::invalid_argument If there are labels, but not one per node.
+ */
+inline BoundaryConditions
+boundaryValuesOf(const std::vector<double> &field,
+                 const std::vector<double> &labels = {}) {
+  if (!labels.empty() && labels.size() != field.size()) {
+    throw std::invalid_argument("The labels of the sources are " +
+                                std::to_string(labels.size()) +
+                                " values, the times " +
+                                std::to_string(field.size()));
+  }
+  BoundaryConditions boundary;
+  for (std::size_t id = 0; id < field.size(); ++id) {
+    if (field[id] >= 0.0) {
+      boundary.add(static_cast<unsigned int>(id), field[id],
+                   labels.empty() ? -1 : static_cast<int>(labels[id]));
+    }
+  }
+  return boundary;
+}
+
+/**
+ * @brief The boundary values of a point source at any position in the mesh.
+ *
+ * The vertices of the element that contains the point start at their exact
+ * travel time from it, time + sqrt(d^T M d) with the M of the element, so
+ * that the source needs no vertex of its own, nor a mesh refined around it.
+ *
+ * @param locator The spatial index of geometry.
+ * @param label The label of the vertices, as one source.
+ * @throw std::invalid_argument If no element contains the point.
+ */
+template <unsigned int PHDIM>
+BoundaryConditions
+pointSource(const MeshGeometry<PHDIM> &geometry,
+            const PointLocator<PHDIM> &locator,
+            const typename Eikonal_traits<PHDIM>::Point &p,
+            double time = 0.0, int label = -1) {
+  const std::size_t e = locator.locate(p);
+  if (e == PointLocator<PHDIM>::none) {
+    throw std::invalid_argument("The source point is not in the mesh");
+  }
+  const auto M = geometry.anisotropyOf(e);
+  BoundaryConditions boundary;
+  for (auto id : geometry.element(e)) {
+    const typename Eikonal_traits<PHDIM>::Point d = geometry.point(id) - p;
+    boundary.add(id, time + std::sqrt(d.dot(M * d)), label);
+  }
+  return boundary;
+}
+
+} // namespace Eikonal
+
+#endif // BOUNDARYCONDITIONS_HPP
@@ -0,0 +1,163 @@
+#ifndef CHANGESET_HPP
+#define CHANGESET_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MeshGeometry.hpp"
+#include "SolveState.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief What changed since a solve: the sources added and removed and the
+ * elements whose speed (anisotropy) changed, by id. The sources added start
+ * at 0 and are labelled with their id.
+ */
+struct ChangeSet {
+  std::vector<unsigned int> addedSources;
+  std::vector<unsigned int> removedSources;
+  std::vector<std::size_t> changedElements;
+};
+
+/**
+ * @brief Apply a change set to the values of a converged solve, and return
+ * the nodes from which the propagation must restart.
+ *
+ * Adding a source only lowers values, which the propagation does from the
+ * neighbours of the new source. Removing a source or changing the speed of
+ * an element may also raise them, so the removed sources and the vertices of
+ * the changed elements are set back to unreached, and so is, in turn, every
+ * neighbour of an unreached node whose value the nodes left no longer
+ * support: its local solve without its own value is larger by more than
+ * tolerance. Only the neighbours with a value not smaller are tried, as a
+ * value comes from the base of a local problem, whose values are not larger
+ * (causality). The nodes returned are the unreached ones next to a node
+ * kept, and the neighbours of the new sources, possibly more than once. The
+ * work is proportional to the region set back and its neighbours; past half
+ * of the nodes the search stops and every value is reset, as for a solve
+ * from scratch.
+ *
+ * Nothing is changed if the change set is not valid.
+ *
+ * @param geometry The mesh, possibly a new one with the same nodes and
+ * elements but a different speed.
+ * @param state The values and sources of the previous solve.
+ * @param unreached The value of the nodes not reached yet (INF).
+ * @param tolerance The convergence tolerance of the solve (EPSILON).
+ * @param solve The smallest local solution around a node, given state, or
+ * its value if none is lower.
+ * @throw std::invalid_argument If an added source is not a node of the
+ * mesh, a removed source is not a source, or an element does not exist.
+ */
+template <unsigned int PHDIM, typename LocalSolve>
+std::vector<unsigned int>
+applyChanges(const MeshGeometry<PHDIM> &geometry, SolveState &state,
+             const ChangeSet &changes, double unreached, double tolerance,
+             LocalSolve &&solve) {
+  for (auto id : changes.addedSources) {
+    if (id >= state.size() || !geometry.hasNode(id)) {
+      throw std::invalid_argument("Source node " + std::to_string(id) +
+                                  " is not in the mesh");
+    }
+  }
+  for (auto id : changes.removedSources) {
+    if (id >= state.size() || !state.isSource[id]) {
+      throw std::invalid_argument("Node " + std::to_string(id) +
+                                  " is not a source");
+    }
+  }
+  for (auto e : changes.changedElements) {
+    if (e >= geometry.numElements()) {
+      throw std::invalid_argument("Element " + std::to_string(e) +
+                                  " is not in the mesh");
+    }
+  }
+
+  // The invalidated nodes with their previous value; a node is set to
+  // unreached as soon as it is found, so that it is found once.
+  std::vector<std::pair<unsigned int, double>> invalid;
+  auto invalidate = [&](unsigned int id) {
+    if (!state.isSource[id] && state.u[id] < unreached) {
+      invalid.emplace_back(id, state.u[id]);
+      state.u[id] = unreached;
+    }
+  };
+  for (auto id : changes.removedSources) {
+    state.isSource[id] = 0;
+    state.label[id] = -1;
+    invalidate(id);
+  }
+  for (auto e : changes.changedElements) {
+    for (auto id : geometry.element(e)) {
+      invalidate(id);
+    }
+  }
+  const auto &adjacency = geometry.getAdjacency();
+  const std::size_t limit = state.size() / 2;
+  for (std::size_t i = 0; i < invalid.size() && invalid.size() <= limit;
+       ++i) {
+    const auto [id, value] = invalid[i];
+    for (auto neighbour : adjacency.neighboursOf(id)) {
+      const double previous = state.u[neighbour];
+      if (state.isSource[neighbour] || previous >= unreached ||
+          previous < value) {
+        continue;
+      }
+      state.u[neighbour] = unreached;
+      if (solve(neighbour) <= previous + tolerance) {
+        state.u[neighbour] = previous;
+      } else {
+        invalid.emplace_back(neighbour, previous);
+      }
+    }
+  }
+
+  std::vector<unsigned int> frontier;
+  if (invalid.size() > limit) {
+    // Most of the values go: starting over is cheaper than the search
+    for (std::size_t id = 0; id < state.size(); ++id) {
+      if (!state.isSource[id]) {
+        state.u[id] = unreached;
+      }
+    }
+    for (auto id : changes.addedSources) {
+      state.addSource(id);
+    }
+    for (std::size_t id = 0; id < state.size(); ++id) {
+      if (!state.isSource[id]) {
+        continue;
+      }
+      for (auto neighbour : adjacency.neighboursOf(id)) {
+        if (!state.isSource[neighbour]) {
+          frontier.push_back(neighbour);
+        }
+      }
+    }
+    return frontier;
+  }
+  for (const auto &entry : invalid) {
+    for (auto neighbour : adjacency.neighboursOf(entry.first)) {
+      if (state.u[neighbour] < unreached) {
+        frontier.push_back(entry.first);
+        break;
+      }
+    }
+  }
+  for (auto id : changes.addedSources) {
+    state.addSource(id);
+    for (auto neighbour : adjacency.neighboursOf(id)) {
+      if (!state.isSource[neighbour]) {
+        frontier.push_back(neighbour);
+      }
+    }
+  }
+  return frontier;
+}
+
+} // namespace Eikonal
+
+#endif // CHANGESET_HPP
@@ -0,0 +1,184 @@
+/*
+ * Diagnostics.hpp
+ *
+ *  Counters of the rare events of the solvers (activations, failed line
+ *  searches, fallback directions), in place of printing them.
+ */
+
+#ifndef EXAMPLES_SRC_LINESEARCH_DIAGNOSTICS_HPP_
+#define EXAMPLES_SRC_LINESEARCH_DIAGNOSTICS_HPP_
+#include <array>
+#include <cstddef>
+#include <ostream>
+#ifdef EIKONAL_DIAGNOSTICS
+#include <atomic>
+#include <iostream>
+#endif
+namespace apsc::diagnostics
+{
+//! The events that are counted
+enum class Event : unsigned int
+{
+  NodeActivated,       //!< A node entered the active list of a solver
+  NonDescentDirection, //!< Line search stopped: not a descent direction
+  BacktrackFailed,     //!< Line search stopped: no sufficient decrease
+  MaxIterations,       //!< Line search stopped at the maximum iterations
+  GradientFallback,    //!< Backtracking reverted to the gradient direction
+  NumEvents
+};
+
+constexpr std::size_t numEvents = static_cast<std::size_t>(Event::NumEvents);
+
+//! A readable name of an event
+inline char const *
+name(Event event)
+{
+  constexpr std::array<char const *, numEvents> names = {
+    "node activations", "non-descent directions", "failed backtrackings",
+    "max iterations", "gradient fallbacks"};
+  return names[static_cast<std::size_t>(event)];
+}
+
+//! The counts of every event, summed over the threads
+struct Snapshot
+{
+  std::array<std::size_t, numEvents> counts{};
+
+  std::size_t
+  operator[](Event event) const
+  {
+    return counts[static_cast<std::size_t>(event)];
+  }
+};
+
+inline std::ostream &
+operator<<(std::ostream &out, Snapshot const &snapshot)
+{
+  for(std::size_t i = 0; i < numEvents; ++i)
+    out << (i == 0 ? "" : ", ") << name(static_cast<Event>(i)) << ": "
+        << snapshot.counts[i];
+  return out;
+}
+
+#ifdef EIKONAL_DIAGNOSTICS
+//! Whether the events are counted (the library was built with EIKONAL_DIAGNOSTICS)
+constexpr bool enabled = true;
+
+namespace internal
+{
+  //! Threads with counters of their own; later threads share overflow
+  constexpr std::size_t maxThreads = 256;
+
+  /*!
+   * The counters of one thread, on a cache line of their own. Only the
+   * owner writes them, with a relaxed load and store (no
+   * read-modify-write); snapshot() may read them at any time. The slots
+   * are static, so that the first count() of a thread, which may happen in
+   * the middle of a solve, neither locks nor allocates.
+   */
+  struct alignas(64) ThreadCounters
+  {
+    std::array<std::atomic<std::size_t>, numEvents> counts{};
+  };
+
+  inline std::array<ThreadCounters, maxThreads> slots{};
+  //! Shared by the threads past maxThreads, written with fetch_add
+  inline ThreadCounters overflow;
+  inline std::atomic<std::size_t> nextSlot{0};
+  //! Messages written so far, per event
+  inline std::array<std::atomic<std::size_t>, numEvents> logged{};
+  //! Messages written at most per event, 0 for none
+  inline std::atomic<std::size_t> logLimit{0};
+
+  //! The slot of the calling thread, taken at its first call and kept
+  inline std::size_t
+  slot()
+  {
+    thread_local std::size_t const index =
+      nextSlot.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+} // namespace internal
+
+/*!
+ * Counts an event in the counters of the calling thread, and writes it to
+ * std::clog if fewer than logLimit() messages of that event were written.
+ */
+inline void
+count(Event event)
+{
+  auto const i = static_cast<std::size_t>(event);
+  auto const slot = internal::slot();
+  if(slot < internal::maxThreads)
+    {
+      auto &counter = internal::slots[slot].counts[i];
+      counter.store(counter.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+    }
+  else
+    internal::overflow.counts[i].fetch_add(1, std::memory_order_relaxed);
+  if(internal::logLimit.load(std::memory_order_relaxed) > 0 and
+     internal::logged[i].fetch_add(1, std::memory_order_relaxed) <
+       internal::logLimit.load(std::memory_order_relaxed))
+    std::clog << "Diagnostics: " << name(event) << "\n";
+}
+
+//! The counts of every event since the start or the last reset()
+inline Snapshot
+snapshot()
+{
+  Snapshot result;
+  for(std::size_t i = 0; i < numEvents; ++i)
+    result.counts[i] = internal::overflow.counts[i].load(std::memory_order_relaxed);
+  for(auto const &counters : internal::slots)
+    for(std::size_t i = 0; i < numEvents; ++i)
+      result.counts[i] += counters.counts[i].load(std::memory_order_relaxed);
+  return result;
+}
+
+//! Sets the counts to zero; not to be called while events are counted
+inline void
+reset()
+{
+  for(auto &counter : internal::overflow.counts)
+    counter.store(0, std::memory_order_relaxed);
+  for(auto &counters : internal::slots)
+    for(auto &counter : counters.counts)
+      counter.store(0, std::memory_order_relaxed);
+  for(auto &messages : internal::logged)
+    messages.store(0, std::memory_order_relaxed);
+}
+
+/*!
+ * Writes the first limit events of every kind to std::clog (0, the
+ * default, writes none)
+ */
+inline void
+setLogLimit(std::size_t limit)
+{
+  internal::logLimit.store(limit, std::memory_order_relaxed);
+}
+#else
+constexpr bool enabled = false;
+
+//! Does nothing: the library was built without EIKONAL_DIAGNOSTICS
+inline void
+count(Event)
+{}
+
+inline Snapshot
+snapshot()
+{
+  return {};
+}
+
+inline void
+reset()
+{}
+
+inline void
+setLogLimit(std::size_t)
+{}
+#endif
+} // namespace apsc::diagnostics
+#endif /* EXAMPLES_SRC_LINESEARCH_DIAGNOSTICS_HPP_ */
@@ -2,15 +2,30 @@
 #define EIKONALSOLVER_HPP
 
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include "BatchedLocalSolver.hpp"
+#include "BoundaryConditions.hpp"
+#include "ChangeSet.hpp"
+#include "Diagnostics.hpp"
+#include "LambdaCache.hpp"
+#include "LocalProblemBounds.hpp"
+#include "LocalSolutionCache.hpp"
+#include "LocalSolverEngine.hpp"
+#include "MeshAdjacency.hpp"
 #include "MeshElement.hpp"
+#include "MeshGeometry.hpp"
 #include "EikonalSolver.hpp"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
-#include "solveEikonalLocalProblem.hpp"
+#include "SolveState.hpp"
+#include "SolverStatistics.hpp"
+#include "SourceLabels.hpp"
+#include "StoppingCriteria.hpp"
+#include "ToleranceSchedule.hpp"
+#include "solveEikonalLocalProblemAnalytic.hpp"
 
 const double INF = 10e7;
 const double EPSILON = 1e-6;
@@ -21,43 +36,144 @@ class EikonalSolver
     using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
 
 public:
-    EikonalSolver(std::vector<Mesh_element<PHDIM>> &mesh, Mat &matrix) : mesh(mesh), mat(matrix)
+    // The geometry of the mesh is copied into a MeshGeometry of its own, the
+    // sources are the nodes flagged isSource, and the values are written back
+    // to the nodes (Node::u) at construction and after every update
+    EikonalSolver(std::vector<Mesh_element<PHDIM>> &mesh, Mat &matrix)
+        : EikonalSolver(std::make_shared<const Eikonal::MeshGeometry<PHDIM>>(mesh, matrix), sourcesOf(mesh))
     {
+        publishToNodes = true;
+        publish();
+    }
+
+    // A solver on a shared mesh: the geometry is only read, so several
+    // solvers may share it and run at the same time; the values are kept in
+    // the solver (see getValues). Throws std::invalid_argument if a source is
+    // not a node of the mesh
+    EikonalSolver(std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+                  const std::vector<unsigned int> &sources)
+        : geometry(std::move(geometry)), adjacency(this->geometry->getAdjacency()),
+          bounds(this->geometry->getBounds()), mat(this->geometry->getAnisotropy())
+    {
+        state.resize(this->geometry->numNodes(), INF);
+        state.setSources(sources);
         initializeMaps();
         initialize();
     }
 
+    // A solver on a shared mesh from boundary values: every node given is a
+    // source with its own starting time, e.g. the vertices around a point
+    // source (see Eikonal::pointSource) or a POINT_DATA field of the input
+    // file (see Eikonal::boundaryValuesOf). Throws std::invalid_argument if
+    // a node is not in the mesh or a time is not finite
+    EikonalSolver(std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+                  const Eikonal::BoundaryConditions &boundary)
+        : geometry(std::move(geometry)), adjacency(this->geometry->getAdjacency()),
+          bounds(this->geometry->getBounds()), mat(this->geometry->getAnisotropy())
+    {
+        state.resize(this->geometry->numNodes(), INF);
+        state.setBoundaryValues(boundary.values);
+        initializeMaps();
+        initialize();
+    }
+
+    // A solver that continues a previous solve (see getState) after the
+    // changes, applied as by applyChanges, on the same mesh or on one with
+    // the same nodes and elements, e.g. with the speed changed in a region.
+    // Throws std::invalid_argument if previous is not a state of this mesh
+    // or the changes are not valid
+    EikonalSolver(std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+                  const Eikonal::SolveState &previous, const Eikonal::ChangeSet &changes)
+        : geometry(std::move(geometry)), adjacency(this->geometry->getAdjacency()),
+          bounds(this->geometry->getBounds()), mat(this->geometry->getAnisotropy()), state(previous)
+    {
+        if (state.size() != this->geometry->numNodes())
+        {
+            throw std::invalid_argument("The previous solve has " + std::to_string(state.size()) +
+                                        " nodes, the mesh " + std::to_string(this->geometry->numNodes()));
+        }
+        initializeMaps();
+        applyChanges(changes);
+    }
+
+    // Prepare the next update after sources were added or removed, or the
+    // speed of some elements changed: only the nodes the changes may affect
+    // are reset (see Eikonal::applyChanges), and update() propagates from
+    // the boundary of that region. The values must have converged. Throws
+    // std::invalid_argument if the changes are not valid, changing nothing
+    void applyChanges(const Eikonal::ChangeSet &changes)
+    {
+        auto solve = [this](unsigned int id)
+        {
+            bool approximate;
+            return solveLocal(id, approximate);
+        };
+        for (auto id : Eikonal::applyChanges(*geometry, state, changes, INF, EPSILON, solve))
+        {
+            if (!isInActiveList(id))
+            {
+                activeList.push_back(id);
+            }
+        }
+    }
+
     void update()
     {
+        // toAdd and toRemove are members: they keep their capacity, so the
+        // propagation does not allocate
         while (!activeList.empty())
         {
-            std::vector<int> toAdd;
-            std::vector<int> toRemove;
+            toAdd.clear();
+            toRemove.clear();
+            const double limit = termination.threshold(state.u);
 
             for (auto it = activeList.begin(); it != activeList.end(); ++it)
             {
-                NodePtr<PHDIM> node = nodes[*it];
-                double previous_value = node->u;
-                node->u = solveLocal(*node);
+                if (!termination.inside(*it))
+                {
+                    toRemove.push_back(*it);
+                    continue;
+                }
+                double &u = state.u[*it];
+                bool approximate;
+                double previous_value = u;
+                u = solveLocal(*it, approximate);
+                // A node reached for the first time has no change to record
+                if (previous_value < INF)
+                {
+                    tolerances.record(*it, std::abs(previous_value - u));
+                }
 
-                if (std::abs(previous_value - node->u) < EPSILON)
+                // A loose solve never declares the node converged
+                if (std::abs(previous_value - u) < EPSILON && !approximate)
                 {
-                    for (auto &neighbour : getNeighbours(*node))
+                    for (auto neighbour_id : adjacency.neighboursOf(*it))
                     {
-                        if (std::find(activeList.begin(), activeList.end(), neighbour->id) == activeList.end() && !neighbour->isSource)
+                        if (!isInActiveList(neighbour_id) && !state.isSource[neighbour_id])
                         {
-                            double p = neighbour->u;
-                            double q = solveLocal(*neighbour);
-                            if (p > q)
+                            double p = state.u[neighbour_id];
+                            bool neighbour_approximate;
+                            double q = solveLocal(neighbour_id, neighbour_approximate);
+                            if (p > q && termination.admits(neighbour_id, q, limit))
                             {
-                                neighbour->u = q;
-                                toAdd.push_back(neighbour->id);
-                                std::cout << neighbour->id << std::endl;
+                                state.u[neighbour_id] = q;
+                                if (p < INF)
+                                {
+                                    tolerances.record(neighbour_id, p - q);
+                                }
+                                toAdd.push_back(neighbour_id);
+                                apsc::diagnostics::count(apsc::diagnostics::Event::NodeActivated);
                             }
                         }
                     }
                     toRemove.push_back(*it);
                 }
+                else if (u > limit)
+                {
+                    // Beyond the stopping threshold: reached again by its
+                    // neighbours if its value comes down
+                    toRemove.push_back(*it);
+                }
             }
 
             for (const auto &id : toRemove)
@@ -70,135 +186,441 @@ public:
                 activeList.push_back(id);
             }
         }
+        if (termination.enabled())
+        {
+            termination.finish(state.u, state.isSource, INF);
+        }
+        publish();
     }
 
     void printResults() const
     {
-        for (const auto &pair : nodes)
+        for (std::size_t id = 0; id < state.size(); ++id)
         {
-            std::cout << "Node " << pair.second->id << ": u = " << pair.second->u << std::endl;
+            if (geometry->hasNode(id))
+            {
+                std::cout << "Node " << id << ": u = " << state.u[id] << std::endl;
+            }
         }
     }
-    std::vector<NodePtr<PHDIM>> getNeighbours(Node<PHDIM> &node)
+
+    // The values of the nodes, by id
+    const Eikonal::NodeValues &getValues() const
     {
-        std::unordered_set<unsigned int> neighbour_ids;
-        std::vector<NodePtr<PHDIM>> neighbours;
+        return state.u;
+    }
+
+    // The label of the source every node is reached from first, -1 for the
+    // nodes not reached (see Eikonal::sourceLabels): the sources given by id
+    // are labelled with their id, the boundary values carry their own label.
+    // Computed on each call, after the update
+    std::vector<int> getSourceLabels() const
+    {
+        return Eikonal::sourceLabels(*geometry, state, INF);
+    }
 
-        for (auto &mesh_element : nodeToElements[node.id])
+    // The values and the sources, to continue the solve after a change
+    const Eikonal::SolveState &getState() const
+    {
+        return state;
+    }
+
+    // Let the next updates stop before every node is reached: the nodes
+    // beyond the travel time or the targets of the criteria, or out of their
+    // region, are left unreached (INF, see isReached), the other values are
+    // those of a full solve, along paths in the region if there is one (see
+    // Eikonal::EarlyTermination). Throws std::invalid_argument if a target is
+    // not a node of the mesh
+    void setStoppingCriteria(const Eikonal::StoppingCriteria<PHDIM> &criteria)
+    {
+        termination.enable(criteria, *geometry);
+    }
+
+    // Run the next updates until every node is reached
+    void clearStoppingCriteria()
+    {
+        termination.disable();
+    }
+
+    // Whether a node has a value: false for the nodes left out by the
+    // stopping criteria and for those no source reaches
+    bool isReached(std::size_t id) const
+    {
+        return state.u[id] < INF;
+    }
+
+    // The mesh the solver works on, to be shared with other solvers
+    const std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> &getGeometry() const
+    {
+        return geometry;
+    }
+    // Solver of the local problems, Eikonal::defaultLocalSolver unless set
+    void setLocalSolver(Eikonal::LocalSolverType type)
+    {
+        localSolver = type;
+        engine.reset();
+        // The cached solutions came from the previous local solver
+        solutionCache.clear();
+    }
+
+    // Solver of the local problems by name, see Eikonal::LocalSolverEngineFactory;
+    // throws std::invalid_argument for an unknown name
+    void setLocalSolver(const std::string &name)
+    {
+        std::shared_ptr<const Eikonal::LocalSolverEngine<PHDIM>> created =
+            Eikonal::makeLocalSolverEngine<PHDIM>(name);
+        setLocalSolver(created->type());
+        // The built-in solvers keep their own code path
+        if (localSolver == Eikonal::LocalSolverType::LineSearch)
         {
-            for (auto &mesh_node : mesh_element.vertex)
-            {
-                if (node.id != mesh_node->id && neighbour_ids.find(mesh_node->id) == neighbour_ids.end())
-                {
-                    neighbour_ids.insert(mesh_node->id);
-                    neighbours.push_back(nodes[mesh_node->id]);
-                }
-            }
+            engine = std::move(created);
+        }
+    }
+
+    Eikonal::LocalSolverType getLocalSolver() const
+    {
+        return localSolver;
+    }
+
+    // Tolerances and iteration limits of the iterative local solvers; they
+    // belong to this solver, so solvers with different options may run at
+    // the same time
+    void setLocalSolverOptions(const Eikonal::LocalSolverOptions &options)
+    {
+        localOptions = options;
+        // The cached solutions were computed with the previous options
+        solutionCache.clear();
+    }
+
+    const Eikonal::LocalSolverOptions &getLocalSolverOptions() const
+    {
+        return localOptions;
+    }
+
+    // Adaptive tolerances of the iterative local solvers: a node is solved
+    // with a tolerance proportional to the last change of its value (see
+    // Eikonal::ToleranceSchedule), and declared converged only after a solve
+    // at schedule.accuracy
+    void setToleranceSchedule(bool enable, const Eikonal::ToleranceSchedule &schedule = {})
+    {
+        if (enable)
+        {
+            tolerances.enable(adjacency.size(), schedule);
         }
+        else
+        {
+            tolerances.disable();
+        }
+        solutionCache.clear();
+    }
 
+    bool isToleranceSchedule() const
+    {
+        return tolerances.enabled();
+    }
+
+    // Local problems solved and skipped since construction or the last reset
+    Eikonal::SolverStatistics getStatistics() const
+    {
+        return statistics;
+    }
+
+    void resetStatistics()
+    {
+        statistics = Eikonal::SolverStatistics{};
+    }
+
+    // Warm start of the Newton local solver: every (node, element) pair
+    // starts from the lambda of its previous solve (see Eikonal::LambdaCache)
+    void setWarmStart(bool enable)
+    {
+        lambdaCache.resize(enable ? adjacency.numElementSlots() : 0);
+    }
+
+    bool isWarmStart() const
+    {
+        return !lambdaCache.empty();
+    }
+
+    // Cache of the local solutions: a (node, element) pair solved again with
+    // the same values at the base reuses its last solution (see
+    // Eikonal::LocalSolutionCache); not used by the batched local solver
+    void setSolutionCache(bool enable)
+    {
+        solutionCache.resize(enable ? adjacency.numElementSlots() : 0);
+    }
+
+    bool isSolutionCache() const
+    {
+        return !solutionCache.empty();
+    }
+
+    std::vector<NodePtr<PHDIM>> getNeighbours(Node<PHDIM> &node)
+    {
+        std::vector<NodePtr<PHDIM>> neighbours;
+        for (auto neighbour_id : adjacency.neighboursOf(node.id))
+        {
+            neighbours.push_back(adjacency.node(neighbour_id));
+        }
         return neighbours;
     }
 
 private:
-    std::vector<Mesh_element<PHDIM>> &mesh;
-    std::unordered_map<unsigned int, NodePtr<PHDIM>> nodes;
-    std::unordered_map<unsigned int, std::vector<Mesh_element<PHDIM>>> nodeToElements;
+    // The shared mesh, and the parts of it used at every local solve
+    std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry;
+    const MeshAdjacency<PHDIM> &adjacency;
+    // Lower bounds used to skip the local problems that cannot help
+    const Eikonal::LocalProblemBounds<PHDIM> &bounds;
+    const Mat &mat;
+    // Values and sources of this solve
+    Eikonal::SolveState state;
+    // Whether the values are copied to the nodes of the mesh (Node::u)
+    bool publishToNodes = false;
     std::vector<int> activeList;
-    Mat &mat;
+    std::vector<int> toAdd;
+    std::vector<int> toRemove;
+    Eikonal::LocalSolverType localSolver = Eikonal::defaultLocalSolver;
+    // The engine set by name, null for the built-in local solvers
+    std::shared_ptr<const Eikonal::LocalSolverEngine<PHDIM>> engine;
+    // Options of the iterative local solvers
+    Eikonal::LocalSolverOptions localOptions;
+    // Last change of every node, empty without a tolerance schedule
+    Eikonal::AdaptiveTolerance tolerances;
+    Eikonal::EarlyTermination<PHDIM> termination;
+    Eikonal::SolverStatistics statistics;
+    // Last lambda of every (node, element) pair, empty without warm start
+    Eikonal::LambdaCache<PHDIM> lambdaCache;
+    // Last solution of every (node, element) pair, empty unless enabled
+    Eikonal::LocalSolutionCache<PHDIM> solutionCache;
 
-    bool isInActiveList(Node<PHDIM> &node)
+    bool isInActiveList(unsigned int id) const
     {
-        return std::find(activeList.begin(), activeList.end(), node.id) != activeList.end();
+        return std::find(activeList.begin(), activeList.end(), static_cast<int>(id)) != activeList.end();
     }
 
-    void initializeMaps()
+    // The ids of the nodes flagged isSource
+    static std::vector<unsigned int> sourcesOf(const std::vector<Mesh_element<PHDIM>> &mesh)
+    {
+        std::vector<unsigned int> sources;
+        for (const auto &element : mesh)
+        {
+            for (const auto &vertex : element.vertex)
+            {
+                if (vertex->isSource)
+                {
+                    sources.push_back(vertex->id);
+                }
+            }
+        }
+        return sources;
+    }
+
+    // Copy the values to the nodes of the mesh, when built from them
+    void publish()
     {
-        for (size_t i = 0; i < mesh.size(); ++i)
+        if (!publishToNodes)
+        {
+            return;
+        }
+        for (std::size_t id = 0; id < state.size(); ++id)
         {
-            for (auto &node : mesh[i].vertex)
+            if (const auto &node = adjacency.node(id))
             {
-                nodes[node->id] = node;
-                nodeToElements[node->id].push_back(mesh[i]);
+                node->u = state.u[id];
             }
         }
     }
 
+    void initializeMaps()
+    {
+        // A node is never twice in the active list
+        activeList.reserve(adjacency.size());
+        toAdd.reserve(adjacency.size());
+        toRemove.reserve(adjacency.size());
+    }
+
     void initialize()
     {
-        for (auto &m_element : mesh)
+        for (std::size_t e = 0; e < geometry->numElements(); ++e)
         {
-            for (auto &node : m_element.vertex)
+            for (auto id : geometry->element(e))
             {
-                if (node->isSource)
+                if (state.isSource[id])
                 {
-                    node->u = 0.0;
-                    for (auto &neighbour : getNeighbours(*node))
+                    for (auto neighbour_id : adjacency.neighboursOf(id))
                     {
-                        if (!isInActiveList(*neighbour) && !neighbour->isSource)
+                        if (!isInActiveList(neighbour_id) && !state.isSource[neighbour_id])
                         {
-                            activeList.push_back(neighbour->id);
+                            activeList.push_back(neighbour_id);
                         }
                     }
                 }
                 else
                 {
-                    node->u = INF;
+                    state.u[id] = INF;
                 }
             }
         }
     }
 
-    double solveLocal(Node<PHDIM> &node)
+    // The smallest local solution around the node, or its current value if
+    // none is lower; approximate tells whether a local solve was loose and
+    // iterated (see solveSimplex), so that the node cannot be converged
+    double solveLocal(unsigned int id, bool &approximate)
     {
         using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
         using VectorExt = typename Eikonal::Eikonal_traits<PHDIM>::VectorExt;
 
-        double min_value = INF;
-        std::vector<NodePtr<PHDIM>> nodes_for_points;
+        // The tolerances of the schedule for this node, if any
+        const auto options = tolerances.options(id, localOptions);
+        approximate = false;
+        double min_value = state.u[id];
+        // Only used by LocalSolverType::Batched
+        Eikonal::simd::LocalProblemBatch<PHDIM> batch;
+        const auto elements = adjacency.elementsOf(id);
 
-        for (auto &mesh_element : nodeToElements[node.id])
+        for (std::size_t idx = 0; idx < elements.size(); ++idx)
         {
-            for (auto &mesh_node : mesh_element.vertex)
+            const auto e = elements.first[idx];
+            if (skipElement(id, e))
+            {
+                continue;
+            }
+
+            // The simplex is made of the other vertices and the current point,
+            // filled in place so that no temporary is allocated
+            std::array<Point, PHDIM + 1> simplex_points;
+            VectorExt values;
+            unsigned int count = 0;
+            for (auto vertex : geometry->element(e))
             {
-                if (mesh_node->id != node.id)
+                if (vertex != id && count < PHDIM)
                 {
-                    nodes_for_points.push_back(nodes[mesh_node->id]);
+                    simplex_points[count] = geometry->point(vertex);
+                    values[count] = state.u[vertex];
+                    ++count;
                 }
             }
 
             // Controllo per avere abbastanza nodi per formare un simplex di PHDIM + 1 punti
-            if (nodes_for_points.size() < PHDIM)
+            if (count < PHDIM)
             {
-                nodes_for_points.clear();
                 continue;
             }
+            simplex_points[PHDIM] = geometry->point(id); // Aggiungi il punto corrente al simplex
 
-            // Creazione dell'array di simplex con PHDIM + 1 punti
-            std::array<Point, PHDIM + 1> simplex_points;
-            for (int i = 0; i < PHDIM; ++i)
+            if (localSolver == Eikonal::LocalSolverType::Batched)
             {
-                simplex_points[i] = nodes_for_points[i]->p;
+                if (geometry->isUniform())
+                {
+                    batch.add(simplex_points, values);
+                }
+                else
+                {
+                    batch.add(simplex_points, values, geometry->tensorOf(e));
+                }
+                ++statistics.localSolves;
+                if (batch.full())
+                {
+                    Eikonal::simd::solveBatch(batch, mat);
+                    min_value = batch.minResult(min_value);
+                    batch.clear();
+                }
+                continue;
             }
-            simplex_points[PHDIM] = node.p; // Aggiungi il punto corrente al simplex
 
-            // Creazione dei valori estesi con PHDIM valori
-            VectorExt values;
-            for (int i = 0; i < PHDIM; ++i)
+            // Same values at the base as last time: same solution
+            const std::size_t slot = adjacency.elementSlot(id, idx);
+            if (!solutionCache.empty())
             {
-                values[i] = nodes_for_points[i]->u;
+                double cached;
+                if (solutionCache.lookup(slot, values, cached))
+                {
+                    ++statistics.cacheHits;
+                    min_value = std::min(min_value, cached);
+                    continue;
+                }
+                ++statistics.cacheMisses;
             }
 
-            Eikonal::SimplexData<PHDIM> simplex{simplex_points, mat};
-            Eikonal::solveEikonalLocalProblem<PHDIM> solver{simplex, values};
-            auto sol = solver();
-
-            min_value = std::min(min_value, sol.value);
+            bool loose_solution = false;
+            const double value = solveSimplex(slot, e, simplex_points, values, options, loose_solution);
+            approximate = approximate || loose_solution;
+            // Approximate solutions are not cached
+            if (!solutionCache.empty() && !loose_solution)
+            {
+                solutionCache.store(slot, values, value);
+            }
+            min_value = std::min(min_value, value);
+        }
 
-            nodes_for_points.clear();
+        if (batch.size > 0)
+        {
+            Eikonal::simd::solveBatch(batch, mat);
+            min_value = batch.minResult(min_value);
         }
 
         return min_value;
     }
+
+    // Run the local solver on a simplex; with the warm start the iterative
+    // solvers start from the lambda of the previous solve of the same
+    // (node, element) pair, e being the element. approximate is set if the tolerance was looser
+    // than the final one and the solver iterated: a solution found without
+    // iterations (a vertex or an edge satisfying the optimality conditions)
+    // is exact whatever the tolerance
+    template <typename Points, typename Values>
+    double solveSimplex(std::size_t slot, std::size_t e, const Points &simplex_points, const Values &values,
+                        const Eikonal::LocalSolverOptions &options, bool &approximate)
+    {
+        using Lambda = typename Eikonal::Eikonal_traits<PHDIM>::Vector;
+
+        ++statistics.localSolves;
+        const bool loose = Eikonal::isIterative(localSolver) && !tolerances.isFinal(options);
+        if (loose)
+        {
+            ++statistics.looseSolves;
+        }
+        Eikonal::SimplexData<PHDIM> simplex{simplex_points, geometry->anisotropyOf(e)};
+        const bool warm = !lambdaCache.empty() && Eikonal::isIterative(localSolver);
+        Lambda lambda;
+        if (warm && lambdaCache.load(slot, lambda))
+        {
+            ++statistics.warmStarts;
+        }
+        else
+        {
+            lambda.fill(0.333);
+        }
+        auto sol = engine ? engine->solve(simplex, values, lambda, options)
+                          : Eikonal::solveLocalProblem(localSolver, simplex, values, lambda, options);
+        statistics.newtonIterations += sol.iterations;
+        approximate = loose && sol.iterations > 0;
+        if (warm)
+        {
+            lambdaCache.store(slot, sol.lambda);
+        }
+        return sol.value;
+    }
+
+    // Whether the local problem of element e cannot lower the value of the
+    // node (see Eikonal::LocalProblemBounds)
+    bool skipElement(unsigned int id, std::size_t e)
+    {
+        double base_min;
+        const double bound = bounds.lowerBound(e, geometry->element(e), id, state.u, base_min);
+        if (base_min >= INF)
+        {
+            ++statistics.skippedInfinite;
+            return true;
+        }
+        if (bound >= state.u[id])
+        {
+            ++statistics.skippedBound;
+            return true;
+        }
+        return false;
+    }
 };
 
 #endif // EIKONALSOLVER_HPP
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef LAMBDACACHE_HPP
+#define LAMBDACACHE_HPP
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "Eikonal_traits.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief The last lambda found for every (node, element) pair.
+ *
+ * Used to warm-start the Newton local solver: between two solves of the
+ * same pair only the values at the base change a little, and so does the
+ * foot of the characteristic. The lambdas are stored as floats, packed in
+ * one 64-bit word per pair, which is read and written atomically (relaxed):
+ * a lambda is only a starting point, it only has to be a whole one.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class LambdaCache {
+  static constexpr std::size_t DIM = PHDIM - 1;
+  static_assert(DIM * sizeof(float) <= sizeof(std::uint64_t),
+                "The lambdas of a pair must fit in 64 bits");
+
+public:
+  using Vector = typename Eikonal_traits<PHDIM>::Vector;
+
+  /**
+   * @brief Allocate one empty entry per (node, element) pair, or release
+   * the cache with 0.
+   */
+  void resize(std::size_t num_slots) {
+    slots = num_slots > 0
+                ? std::make_unique<std::atomic<std::uint64_t>[]>(num_slots)
+                : nullptr;
+    count = num_slots;
+    clear();
+  }
+
+  std::size_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+  /**
+   * @brief Forget every lambda.
+   */
+  void clear() {
+    for (std::size_t i = 0; i < count; ++i) {
+      slots[i].store(emptyWord, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief The lambda of a pair, false if there is none yet.
+   */
+  bool load(std::size_t slot, Vector &lambda) const {
+    const std::uint64_t word = slots[slot].load(std::memory_order_relaxed);
+    if (word == emptyWord) {
+      return false;
+    }
+    float packed[2];
+    std::memcpy(packed, &word, sizeof(word));
+    for (std::size_t i = 0; i < DIM; ++i) {
+      lambda[i] = packed[i];
+    }
+    return true;
+  }
+
+  /**
+   * @brief Remember the lambda of a pair; non-finite lambdas are not kept.
+   */
+  void store(std::size_t slot, const Vector &lambda) {
+    float packed[2] = {0.0f, 0.0f};
+    for (std::size_t i = 0; i < DIM; ++i) {
+      if (!std::isfinite(lambda[i])) {
+        return;
+      }
+      packed[i] = static_cast<float>(lambda[i]);
+    }
+    std::uint64_t word;
+    std::memcpy(&word, packed, sizeof(word));
+    slots[slot].store(word, std::memory_order_relaxed);
+  }
+
+private:
+  //! All bits set: two NaNs, never the image of a finite lambda.
+  static constexpr std::uint64_t emptyWord = ~std::uint64_t{0};
+
+  std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+  std::size_t count = 0;
+};
+
+} // namespace Eikonal
+
+#endif // LAMBDACACHE_HPP
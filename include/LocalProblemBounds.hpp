@@ -0,0 +1,113 @@
+#ifndef LOCALPROBLEMBOUNDS_HPP
+#define LOCALPROBLEMBOUNDS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "AtomicUtils.hpp"
+#include "Eikonal_traits.hpp"
+#include "MeshElement.hpp"
+#include "SolveState.hpp"
+#include "solveEikonalLocalProblemAnalytic.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief Lower bounds of the local problems of a mesh.
+ *
+ * The local solution at vertex k of an element is a convex combination of
+ * the values at the other vertices plus the metric distance from vertex k
+ * to a point of the opposite face, so it is never below
+ *   min(values at the base) + distance(k, base).
+ * The distances depend on the geometry only and are computed once, with the
+ * closed-form local solver and zero values at the base.
+ */
+template <unsigned int PHDIM> class LocalProblemBounds {
+  using Point = typename Eikonal_traits<PHDIM>::Point;
+  using VectorExt = typename Eikonal_traits<PHDIM>::VectorExt;
+
+public:
+  /**
+   * @brief Compute the distances of every vertex from its opposite face.
+   *
+   * @param mesh The mesh elements.
+   * @param anisotropyOf The anisotropy matrix of an element, by index.
+   */
+  template <typename AnisotropyOf>
+  void build(const std::vector<Mesh_element<PHDIM>> &mesh,
+             AnisotropyOf &&anisotropyOf) {
+    const long num_elements = static_cast<long>(mesh.size());
+    distance.resize(mesh.size());
+#pragma omp parallel for schedule(static) default(shared)
+    for (long e = 0; e < num_elements; ++e) {
+      const auto M = anisotropyOf(static_cast<std::size_t>(e));
+      for (unsigned int k = 0; k <= PHDIM; ++k) {
+        distance[e][k] = faceDistance(mesh[e], k, M);
+      }
+    }
+  }
+
+  /**
+   * @brief Lower bound of the local problem of an element at one of its
+   * vertices.
+   *
+   * @param e Index of the element.
+   * @param vertices The node ids of the vertices of the element.
+   * @param node_id Id of the vertex where the problem is solved.
+   * @param u The values of the nodes, by id, read atomically.
+   * @param base_min Set to the smallest value at the other vertices.
+   */
+  double lowerBound(std::size_t e,
+                    const std::array<unsigned int, PHDIM + 1> &vertices,
+                    unsigned int node_id, const Eikonal::NodeValues &u,
+                    double &base_min) const {
+    base_min = std::numeric_limits<double>::infinity();
+    double node_distance = 0.0;
+    for (unsigned int k = 0; k <= PHDIM; ++k) {
+      if (vertices[k] == node_id) {
+        node_distance = distance[e][k];
+      } else {
+        base_min = std::min(base_min, atomicLoad(u[vertices[k]]));
+      }
+    }
+    return base_min + node_distance;
+  }
+
+  /**
+   * @brief Metric distance of vertex k of element e from the opposite face.
+   */
+  double distanceOf(std::size_t e, unsigned int k) const {
+    return distance[e][k];
+  }
+
+private:
+  //! Metric distance of vertex k from the opposite face, 0 if degenerate.
+  template <typename Matrix>
+  static double faceDistance(const Mesh_element<PHDIM> &element,
+                             unsigned int k, const Matrix &M) {
+    std::array<Point, PHDIM + 1> points;
+    unsigned int count = 0;
+    for (unsigned int j = 0; j <= PHDIM; ++j) {
+      if (j != k) {
+        points[count++] = element.vertex[j]->p;
+      }
+    }
+    points[PHDIM] = element.vertex[k]->p;
+    SimplexData<PHDIM> simplex{points, M};
+    const double value =
+        solveEikonalLocalProblemAnalytic<PHDIM>{simplex, VectorExt::Zero()}()
+            .value;
+    return std::isfinite(value) ? std::max(value, 0.0) : 0.0;
+  }
+
+  //! distance[e][k]: vertex k of element e from its opposite face.
+  std::vector<std::array<double, PHDIM + 1>> distance;
+};
+
+} // namespace Eikonal
+
+#endif // LOCALPROBLEMBOUNDS_HPP
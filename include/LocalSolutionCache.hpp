@@ -0,0 +1,118 @@
+#ifndef LOCALSOLUTIONCACHE_HPP
+#define LOCALSOLUTIONCACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "Eikonal_traits.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief The last local solution of every (node, element) pair, with the
+ * values at the base it was computed from.
+ *
+ * The geometry of a pair never changes, so when the values at the base are
+ * the same (bit by bit) as in the previous solve the solution is the same
+ * too and the local solver need not run. Each entry is a seqlock: a writer
+ * makes the sequence odd, writes, and makes it even again; a reader only
+ * trusts what it read if the sequence was even and did not change meanwhile.
+ * Writers never wait: if an entry is being written the new solution is just
+ * not stored.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class LocalSolutionCache {
+public:
+  using VectorExt = typename Eikonal_traits<PHDIM>::VectorExt;
+
+  /**
+   * @brief Allocate one empty entry per (node, element) pair, or release
+   * the cache with 0.
+   */
+  void resize(std::size_t num_slots) {
+    slots = num_slots > 0 ? std::make_unique<Slot[]>(num_slots) : nullptr;
+    count = num_slots;
+    clear();
+  }
+
+  std::size_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+  /**
+   * @brief Forget every solution.
+   */
+  void clear() {
+    for (std::size_t i = 0; i < count; ++i) {
+      slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief The solution stored for a pair, if it was computed from values.
+   */
+  bool lookup(std::size_t slot, const VectorExt &values,
+              double &solution) const {
+    const Slot &entry = slots[slot];
+    const std::uint64_t before = entry.sequence.load(std::memory_order_acquire);
+    // 0: never written, odd: being written
+    if (before == 0 || (before & 1) != 0) {
+      return false;
+    }
+    bool same = true;
+    for (unsigned int i = 0; i < PHDIM; ++i) {
+      same = same && entry.input[i].load(std::memory_order_relaxed) ==
+                         toBits(values[i]);
+    }
+    const std::uint64_t output = entry.output.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!same ||
+        entry.sequence.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+    std::memcpy(&solution, &output, sizeof(solution));
+    return true;
+  }
+
+  /**
+   * @brief Store the solution of a pair, unless another thread is storing.
+   */
+  void store(std::size_t slot, const VectorExt &values, double solution) {
+    Slot &entry = slots[slot];
+    std::uint64_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 ||
+        !entry.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                std::memory_order_acquire)) {
+      return;
+    }
+    for (unsigned int i = 0; i < PHDIM; ++i) {
+      entry.input[i].store(toBits(values[i]), std::memory_order_relaxed);
+    }
+    entry.output.store(toBits(solution), std::memory_order_relaxed);
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+private:
+  struct Slot {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> input[PHDIM];
+    std::atomic<std::uint64_t> output;
+  };
+
+  static std::uint64_t toBits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  std::unique_ptr<Slot[]> slots;
+  std::size_t count = 0;
+};
+
+} // namespace Eikonal
+
+#endif // LOCALSOLUTIONCACHE_HPP
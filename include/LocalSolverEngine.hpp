@@ -0,0 +1,312 @@
+#ifndef LOCALSOLVERENGINE_HPP
+#define LOCALSOLVERENGINE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BatchedLocalSolver.hpp"
+#include "DescentDirectionFactory.hpp"
+#include "Factory.hpp"
+#include "solveEikonalLocalProblemAnalytic.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief A local problem: the simplex, the unknown at its last vertex, and
+ * the values at its base.
+ */
+template <unsigned int PHDIM> struct LocalProblemData {
+  SimplexData<PHDIM> simplex;
+  typename Eikonal_traits<PHDIM>::VectorExt values;
+};
+
+/**
+ * @brief A solver of local problems, selected by name at run time (see
+ * LocalSolverEngineFactory).
+ *
+ * The built-in solvers of LocalSolverType are engines, and so is
+ * apsc::LinearSearchSolver with every descent direction of
+ * apsc::DescentDirectionFactory. solve() is const and may be called by
+ * several threads at once.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class LocalSolverEngine {
+public:
+  using AnisotropyM = typename Eikonal_traits<PHDIM>::AnisotropyM;
+  using VectorExt = typename Eikonal_traits<PHDIM>::VectorExt;
+  using Vector = typename EikonalSolution<PHDIM>::Vector;
+
+  virtual ~LocalSolverEngine() = default;
+
+  /**
+   * @brief The built-in solver the engine runs, LineSearch for the descent
+   * directions.
+   */
+  virtual LocalSolverType type() const = 0;
+
+  /**
+   * @brief Solve a local problem; the iterative engines start from
+   * initialLambda and iterate with the given options.
+   */
+  virtual EikonalSolution<PHDIM>
+  solve(const SimplexData<PHDIM> &simplex, const VectorExt &values,
+        const Vector &initialLambda,
+        const LocalSolverOptions &options) const = 0;
+
+  /**
+   * @brief The values of many local problems, as fast as the engine can.
+   *
+   * @param M The anisotropy matrix the simplices were built with.
+   * @param options The options of the iterative engines.
+   */
+  virtual void solveAll(const std::vector<LocalProblemData<PHDIM>> &problems,
+                        const AnisotropyM &M, const LocalSolverOptions &options,
+                        std::vector<double> &values) const {
+    (void)M;
+    Vector initialLambda;
+    initialLambda.fill(0.333);
+    values.resize(problems.size());
+    for (std::size_t i = 0; i < problems.size(); ++i) {
+      values[i] =
+          solve(problems[i].simplex, problems[i].values, initialLambda, options)
+              .value;
+    }
+  }
+};
+
+/**
+ * @brief Engine running one of the built-in local solvers.
+ */
+template <unsigned int PHDIM>
+class BuiltinLocalSolverEngine : public LocalSolverEngine<PHDIM> {
+  using Base = LocalSolverEngine<PHDIM>;
+
+public:
+  explicit BuiltinLocalSolverEngine(LocalSolverType type) : solver(type) {}
+
+  LocalSolverType type() const override { return solver; }
+
+  EikonalSolution<PHDIM>
+  solve(const SimplexData<PHDIM> &simplex, const typename Base::VectorExt &values,
+        const typename Base::Vector &initialLambda,
+        const LocalSolverOptions &options) const override {
+    return solveLocalProblem(solver, simplex, values, initialLambda, options);
+  }
+
+  /**
+   * @brief Batched solves the problems in SIMD batches, the others one by
+   * one.
+   */
+  void solveAll(const std::vector<LocalProblemData<PHDIM>> &problems,
+                const typename Base::AnisotropyM &M,
+                const LocalSolverOptions &options,
+                std::vector<double> &values) const override {
+    if (solver != LocalSolverType::Batched) {
+      Base::solveAll(problems, M, options, values);
+      return;
+    }
+    values.resize(problems.size());
+    simd::LocalProblemBatch<PHDIM> batch;
+    for (std::size_t first = 0; first < problems.size();
+         first += batch.capacity) {
+      batch.clear();
+      for (std::size_t i = first; i < problems.size() && !batch.full(); ++i) {
+        batch.add(problems[i].simplex.points, problems[i].values);
+      }
+      simd::solveBatch(batch, M);
+      std::copy(batch.result, batch.result + batch.size,
+                values.begin() + first);
+    }
+  }
+
+private:
+  LocalSolverType solver;
+};
+
+/**
+ * @brief Engine running apsc::LinearSearchSolver with a descent direction.
+ */
+template <unsigned int PHDIM>
+class LineSearchLocalSolverEngine : public LocalSolverEngine<PHDIM> {
+  using Base = LocalSolverEngine<PHDIM>;
+
+public:
+  /**
+   * @param direction The descent direction, cloned at every solve.
+   */
+  explicit LineSearchLocalSolverEngine(
+      std::unique_ptr<apsc::DescentDirectionBase> direction)
+      : direction(std::move(direction)) {}
+
+  LocalSolverType type() const override { return LocalSolverType::LineSearch; }
+
+  EikonalSolution<PHDIM>
+  solve(const SimplexData<PHDIM> &simplex, const typename Base::VectorExt &values,
+        const typename Base::Vector &initialLambda,
+        const LocalSolverOptions &options) const override {
+    return solveEikonalLocalProblem<PHDIM>{simplex, values, options}(
+        initialLambda, *direction);
+  }
+
+private:
+  std::unique_ptr<apsc::DescentDirectionBase> direction;
+};
+
+/**
+ * @brief The factory of the local solver engines, keyed by name.
+ */
+template <unsigned int PHDIM>
+using LocalSolverEngineFactory =
+    GenericFactory::Factory<LocalSolverEngine<PHDIM>, std::string>;
+
+/**
+ * @brief Register the engines, once, and return the factory.
+ *
+ * The built-in solvers are "Newton", "Analytic" and "Batched"; every
+ * direction "<Name>Direction" of apsc::DescentDirectionFactory gives the
+ * engine "LineSearch/<Name>".
+ */
+template <unsigned int PHDIM>
+LocalSolverEngineFactory<PHDIM> &loadLocalSolverEngines() {
+  auto &factory = LocalSolverEngineFactory<PHDIM>::Instance();
+  // Thread-safe, and only the first call registers
+  static const bool loaded = [&factory]() {
+    const std::vector<std::pair<std::string, LocalSolverType>> builtins = {
+        {"Newton", LocalSolverType::Newton},
+        {"Analytic", LocalSolverType::Analytic},
+        {"Batched", LocalSolverType::Batched}};
+    for (const auto &[name, type] : builtins) {
+      factory.add(name, [type = type]() {
+        return std::make_unique<BuiltinLocalSolverEngine<PHDIM>>(type);
+      });
+    }
+
+    auto &directions = apsc::DescentDirectionFactory::Instance();
+    if (directions.registered().empty()) {
+      apsc::loadDirections();
+    }
+    const std::string suffix = "Direction";
+    for (const auto &direction : directions.registered()) {
+      std::string name = direction;
+      if (name.size() > suffix.size() &&
+          name.compare(name.size() - suffix.size(), suffix.size(), suffix) ==
+              0) {
+        name.erase(name.size() - suffix.size());
+      }
+      factory.add("LineSearch/" + name, [direction]() {
+        return std::make_unique<LineSearchLocalSolverEngine<PHDIM>>(
+            apsc::DescentDirectionFactory::Instance().create(direction));
+      });
+    }
+    return true;
+  }();
+  (void)loaded;
+  return factory;
+}
+
+/**
+ * @brief Create an engine by name.
+ *
+ * @throw std::invalid_argument If there is no engine with that name.
+ */
+template <unsigned int PHDIM>
+std::unique_ptr<LocalSolverEngine<PHDIM>>
+makeLocalSolverEngine(const std::string &name) {
+  return loadLocalSolverEngines<PHDIM>().create(name);
+}
+
+/**
+ * @brief Time and accuracy of an engine on a set of local problems.
+ */
+struct EngineBenchmark {
+  std::string name;
+  //! Seconds per local problem.
+  double time = 0.0;
+  //! Largest error relative to the closed-form solution (absolute below 1).
+  double maxError = 0.0;
+  //! Whether maxError is within the accuracy target.
+  bool accurate = false;
+};
+
+/**
+ * @brief Time every registered engine on a set of local problems.
+ *
+ * The reference solution is the closed-form one ("Analytic"), which is
+ * exact up to rounding.
+ *
+ * @param problems The local problems, e.g. those of a mesh with the values
+ * of a converged solution.
+ * @param M The anisotropy matrix the simplices were built with.
+ * @param tolerance The accuracy target on the error.
+ * @param repetitions Times every engine solves the whole set.
+ * @param options The options of the iterative engines.
+ */
+template <unsigned int PHDIM>
+std::vector<EngineBenchmark>
+benchmarkLocalSolverEngines(const std::vector<LocalProblemData<PHDIM>> &problems,
+                            const typename Eikonal_traits<PHDIM>::AnisotropyM &M,
+                            double tolerance, int repetitions = 1,
+                            const LocalSolverOptions &options = {}) {
+  using Clock = std::chrono::steady_clock;
+  auto &factory = loadLocalSolverEngines<PHDIM>();
+
+  std::vector<double> reference;
+  factory.create("Analytic")->solveAll(problems, M, options, reference);
+
+  std::vector<EngineBenchmark> results;
+  std::vector<double> values;
+  for (const auto &name : factory.registered()) {
+    const auto engine = factory.create(name);
+    const auto start = Clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+      engine->solveAll(problems, M, options, values);
+    }
+    const std::chrono::duration<double> duration = Clock::now() - start;
+
+    EngineBenchmark result;
+    result.name = name;
+    result.time = problems.empty()
+                      ? 0.0
+                      : duration.count() / (repetitions * problems.size());
+    for (std::size_t i = 0; i < problems.size(); ++i) {
+      double error = 0.0;
+      // Problems without a finite solution must stay so
+      if (std::isfinite(reference[i]) || std::isfinite(values[i])) {
+        error = std::abs(values[i] - reference[i]) /
+                std::max(1.0, std::abs(reference[i]));
+      }
+      if (!(error <= result.maxError)) {
+        result.maxError = std::isnan(error)
+                              ? std::numeric_limits<double>::infinity()
+                              : error;
+      }
+    }
+    result.accurate = result.maxError <= tolerance;
+    results.push_back(result);
+  }
+  return results;
+}
+
+/**
+ * @brief The fastest accurate engine of a benchmark, empty if none is.
+ */
+inline std::string
+recommendLocalSolverEngine(const std::vector<EngineBenchmark> &results) {
+  const EngineBenchmark *best = nullptr;
+  for (const auto &result : results) {
+    if (result.accurate && (best == nullptr || result.time < best->time)) {
+      best = &result;
+    }
+  }
+  return best != nullptr ? best->name : std::string{};
+}
+
+} // namespace Eikonal
+
+#endif // LOCALSOLVERENGINE_HPP
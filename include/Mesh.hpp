@@ -2,6 +2,7 @@
 #define MESH_HPP
 
 #include <array>
+#include <map>
 #include <vector>
 #include <memory>
 #include <fstream>
@@ -23,9 +24,18 @@ public:
         mesh_elements.reserve(size);
     }
 
+    // A field of the input file: `components` values per node (POINT_DATA)
+    // or per element (CELL_DATA), by id
+    struct DataArray {
+        unsigned int components = 1;
+        std::vector<double> values;
+    };
+
     std::vector<Point> Points;
     std::vector<NodePtr> nodes;
     std::vector<Mesh_element<PHDIM>> mesh_elements;
+    std::map<std::string, DataArray> pointData;
+    std::map<std::string, DataArray> cellData;
 };
 
 #endif
\ No newline at end of file
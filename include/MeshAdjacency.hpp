@@ -0,0 +1,234 @@
+#ifndef MESHADJACENCY_HPP
+#define MESHADJACENCY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <omp.h>
+
+#include "MeshElement.hpp"
+#include "NumaUtils.hpp"
+
+/**
+ * @brief Node-to-element and node-to-node adjacency of a mesh in CSR form.
+ *
+ * Row i lists the elements (indices into the element vector) and the
+ * neighbouring node ids of the node with id i. Both are built in parallel
+ * with a counting sort: per-node counts with atomic increments, an
+ * exclusive prefix sum, then an atomic cursor per row to scatter the
+ * entries. Rows keep the order a serial construction would give (elements
+ * by index, neighbours by first appearance), so results do not depend on
+ * the number of threads.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class MeshAdjacency {
+public:
+  /**
+   * @brief A contiguous row of a CSR array.
+   */
+  struct IndexRange {
+    const unsigned int *first;
+    const unsigned int *last;
+
+    const unsigned int *begin() const { return first; }
+    const unsigned int *end() const { return last; }
+    std::size_t size() const { return static_cast<std::size_t>(last - first); }
+  };
+
+  MeshAdjacency() = default;
+
+  explicit MeshAdjacency(const std::vector<Mesh_element<PHDIM>> &mesh) {
+    build(mesh);
+  }
+
+  /**
+   * @brief Number of node ids (largest id + 1).
+   */
+  std::size_t size() const { return nodes.size(); }
+
+  /**
+   * @brief The node with a given id, null if no element uses that id.
+   */
+  const NodePtr<PHDIM> &node(std::size_t id) const { return nodes[id]; }
+
+  IndexRange elementsOf(std::size_t id) const {
+    return {elementIndices.data() + elementOffsets[id],
+            elementIndices.data() + elementOffsets[id + 1]};
+  }
+
+  /**
+   * @brief Position of the k-th element of row id among all the element
+   * entries: an index for data attached to (node, element) pairs.
+   */
+  std::size_t elementSlot(std::size_t id, std::size_t k) const {
+    return elementOffsets[id] + k;
+  }
+
+  /**
+   * @brief Number of (node, element) pairs.
+   */
+  std::size_t numElementSlots() const { return elementIndices.size(); }
+
+  IndexRange neighboursOf(std::size_t id) const {
+    return {neighbourIndices.data() + neighbourOffsets[id],
+            neighbourIndices.data() + neighbourOffsets[id + 1]};
+  }
+
+  /**
+   * @brief Move the rows of every node id to the NUMA node of the thread
+   * owning the id (see Eikonal::numa::placeByPartition()). The content is
+   * not changed.
+   */
+  void placeByPartition(const std::vector<int> &thread_node) const {
+    Eikonal::numa::placeByPartition(elementOffsets, thread_node);
+    Eikonal::numa::placeByPartition(elementIndices, elementOffsets, thread_node);
+    Eikonal::numa::placeByPartition(neighbourOffsets, thread_node);
+    Eikonal::numa::placeByPartition(neighbourIndices, neighbourOffsets,
+                                    thread_node);
+  }
+
+  void build(const std::vector<Mesh_element<PHDIM>> &mesh) {
+    const long num_elements = static_cast<long>(mesh.size());
+
+    std::size_t max_id = 0;
+#pragma omp parallel for reduction(max : max_id)
+    for (long e = 0; e < num_elements; ++e) {
+      for (const auto &vertex : mesh[e].vertex) {
+        max_id = std::max<std::size_t>(max_id, vertex->id);
+      }
+    }
+    const long num_ids = num_elements > 0 ? static_cast<long>(max_id) + 1 : 0;
+
+    // Node to elements: count, scan, scatter.
+    Eikonal::numa::firstTouch(elementOffsets, num_ids + 1,
+                              [](std::size_t) { return std::size_t{0}; });
+#pragma omp parallel for
+    for (long e = 0; e < num_elements; ++e) {
+      for (const auto &vertex : mesh[e].vertex) {
+#pragma omp atomic
+        ++elementOffsets[vertex->id + 1];
+      }
+    }
+    prefixSum(elementOffsets);
+
+    Eikonal::numa::firstTouchRows(elementIndices, elementOffsets);
+    std::vector<std::size_t> cursor(elementOffsets.begin(),
+                                    elementOffsets.end() - 1);
+#pragma omp parallel for
+    for (long e = 0; e < num_elements; ++e) {
+      for (const auto &vertex : mesh[e].vertex) {
+        std::size_t slot;
+#pragma omp atomic capture
+        slot = cursor[vertex->id]++;
+        elementIndices[slot] = static_cast<unsigned int>(e);
+      }
+    }
+
+    // Scattering leaves the rows in arbitrary order: sort them and pick up
+    // the node pointer from the first element of the row.
+    nodes.assign(num_ids, nullptr);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (long id = 0; id < num_ids; ++id) {
+      auto first = elementIndices.begin() + elementOffsets[id];
+      auto last = elementIndices.begin() + elementOffsets[id + 1];
+      std::sort(first, last);
+      if (first != last) {
+        for (const auto &vertex : mesh[*first].vertex) {
+          if (vertex->id == static_cast<unsigned int>(id)) {
+            nodes[id] = vertex;
+          }
+        }
+      }
+    }
+
+    // Node to neighbours: the rows are small, so each one is deduplicated
+    // by a linear search, once to count and once to fill.
+    Eikonal::numa::firstTouch(neighbourOffsets, num_ids + 1,
+                              [](std::size_t) { return std::size_t{0}; });
+#pragma omp parallel
+    {
+      std::vector<unsigned int> row;
+#pragma omp for schedule(dynamic, 64)
+      for (long id = 0; id < num_ids; ++id) {
+        collectNeighbours(mesh, id, row);
+        neighbourOffsets[id + 1] = row.size();
+      }
+    }
+    prefixSum(neighbourOffsets);
+
+    Eikonal::numa::firstTouchRows(neighbourIndices, neighbourOffsets);
+#pragma omp parallel
+    {
+      std::vector<unsigned int> row;
+#pragma omp for schedule(dynamic, 64)
+      for (long id = 0; id < num_ids; ++id) {
+        collectNeighbours(mesh, id, row);
+        std::copy(row.begin(), row.end(),
+                  neighbourIndices.begin() + neighbourOffsets[id]);
+      }
+    }
+  }
+
+private:
+  std::vector<NodePtr<PHDIM>> nodes;
+  //! The CSR arrays, first touched by the threads owning their rows (see
+  //! Eikonal::numa::firstTouch()).
+  Eikonal::numa::PartitionedVector<std::size_t> elementOffsets;
+  Eikonal::numa::PartitionedVector<unsigned int> elementIndices;
+  Eikonal::numa::PartitionedVector<std::size_t> neighbourOffsets;
+  Eikonal::numa::PartitionedVector<unsigned int> neighbourIndices;
+
+  /**
+   * @brief The distinct neighbours of a node, in order of first appearance
+   * in its elements.
+   */
+  void collectNeighbours(const std::vector<Mesh_element<PHDIM>> &mesh,
+                         long id, std::vector<unsigned int> &row) const {
+    row.clear();
+    for (auto e : elementsOf(id)) {
+      for (const auto &vertex : mesh[e].vertex) {
+        if (vertex->id != static_cast<unsigned int>(id) &&
+            std::find(row.begin(), row.end(), vertex->id) == row.end()) {
+          row.push_back(vertex->id);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief In-place prefix sum. With v[0] = 0 and v[i + 1] the count of row
+   * i, it turns the counts into CSR offsets.
+   *
+   * Two passes: every thread sums its block, the block totals are scanned,
+   * then every thread scans its block from its offset.
+   */
+  static void prefixSum(Eikonal::numa::PartitionedVector<std::size_t> &v) {
+    const long n = static_cast<long>(v.size());
+    std::vector<std::size_t> block_sum(omp_get_max_threads() + 1, 0);
+#pragma omp parallel
+    {
+      const int tid = omp_get_thread_num();
+      const int nt = omp_get_num_threads();
+      const long first = n * tid / nt;
+      const long last = n * (tid + 1) / nt;
+      std::size_t sum = 0;
+      for (long i = first; i < last; ++i) {
+        sum += v[i];
+      }
+      block_sum[tid + 1] = sum;
+#pragma omp barrier
+#pragma omp single
+      for (int t = 1; t <= nt; ++t) {
+        block_sum[t] += block_sum[t - 1];
+      }
+      std::size_t running = block_sum[tid];
+      for (long i = first; i < last; ++i) {
+        running += v[i];
+        v[i] = running;
+      }
+    }
+  }
+};
+
+#endif // MESHADJACENCY_HPP
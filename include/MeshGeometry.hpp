@@ -0,0 +1,216 @@
+#ifndef MESHGEOMETRY_HPP
+#define MESHGEOMETRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Cholesky>
+#include <Eigen/Eigenvalues>
+
+#include "AnisotropyField.hpp"
+#include "Eikonal_traits.hpp"
+#include "LocalProblemBounds.hpp"
+#include "MeshAdjacency.hpp"
+#include "MeshElement.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief What a solve needs to know about a mesh and never changes: the
+ * coordinates and the elements by node id, the anisotropy, the adjacency
+ * and the lower bounds of the local problems (which depend on the
+ * anisotropy).
+ *
+ * The anisotropy is either one matrix M for the whole mesh or a field, one
+ * tensor per element (see Eikonal::Tensor), e.g. from a CELL_DATA array of
+ * the input file: the speed of a medium that varies in space, or in
+ * direction from place to place. A node between elements of different
+ * tensors gets the smallest of their local solutions, as always.
+ *
+ * Built once, then only read: any number of solvers, on any number of
+ * threads, may share one through a std::shared_ptr<const MeshGeometry>.
+ * The values of a solve live in the solver (see SolveState).
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class MeshGeometry {
+public:
+  using Point = typename Eikonal_traits<PHDIM>::Point;
+  using MMatrix = typename Eikonal_traits<PHDIM>::MMatrix;
+  //! The node ids of the vertices of an element.
+  using Element = std::array<unsigned int, PHDIM + 1>;
+
+  /**
+   * @param mesh The elements, as read by loadMesh; only their node ids and
+   * coordinates are kept.
+   * @param M The anisotropy matrix.
+   */
+  MeshGeometry(const std::vector<Mesh_element<PHDIM>> &mesh, const MMatrix &M)
+      : anisotropy(M), uniformTensor(compactTensor<PHDIM>(M)) {
+    build(mesh);
+  }
+
+  /**
+   * @param mesh The elements, as read by loadMesh.
+   * @param field The anisotropy of every element, in the order of mesh
+   * (see Eikonal::anisotropyFieldOf()).
+   * @throw std::invalid_argument If there is not one tensor per element, or
+   * a tensor is not symmetric positive definite.
+   */
+  MeshGeometry(const std::vector<Mesh_element<PHDIM>> &mesh,
+               std::vector<Tensor<PHDIM>> field)
+      : anisotropy(MMatrix::Identity()), tensors(std::move(field)) {
+    if (tensors.size() != mesh.size()) {
+      throw std::invalid_argument(
+          "The anisotropy field has " + std::to_string(tensors.size()) +
+          " tensors for " + std::to_string(mesh.size()) + " elements");
+    }
+    for (std::size_t e = 0; e < tensors.size(); ++e) {
+      if (expandTensor<PHDIM>(tensors[e]).llt().info() != Eigen::Success) {
+        throw std::invalid_argument("The anisotropy of element " +
+                                    std::to_string(e) +
+                                    " is not positive definite");
+      }
+    }
+    build(mesh);
+  }
+
+  /**
+   * @brief Number of node ids (largest id + 1).
+   */
+  std::size_t numNodes() const { return points.size(); }
+
+  std::size_t numElements() const { return elements.size(); }
+
+  /**
+   * @brief Whether some element uses the node id.
+   */
+  bool hasNode(std::size_t id) const {
+    return adjacency.elementsOf(id).size() > 0;
+  }
+
+  const Point &point(std::size_t id) const { return points[id]; }
+
+  const Element &element(std::size_t e) const { return elements[e]; }
+
+  /**
+   * @brief Whether one matrix holds for the whole mesh.
+   */
+  bool isUniform() const { return tensors.empty(); }
+
+  /**
+   * @brief The anisotropy matrix of a uniform mesh; with a field, see
+   * anisotropyOf().
+   */
+  const MMatrix &getAnisotropy() const { return anisotropy; }
+
+  /**
+   * @brief The anisotropy matrix of an element.
+   */
+  MMatrix anisotropyOf(std::size_t e) const {
+    return isUniform() ? anisotropy : expandTensor<PHDIM>(tensors[e]);
+  }
+
+  /**
+   * @brief The compact anisotropy of an element, as the batched local
+   * solver reads it.
+   */
+  const Tensor<PHDIM> &tensorOf(std::size_t e) const {
+    return isUniform() ? uniformTensor : tensors[e];
+  }
+
+  const MeshAdjacency<PHDIM> &getAdjacency() const { return adjacency; }
+
+  const LocalProblemBounds<PHDIM> &getBounds() const { return bounds; }
+
+  /**
+   * @brief The largest travel time along an edge, sqrt(d^T M d), with the M
+   * of each element the edge belongs to.
+   *
+   * Computed on each call, in O(number of elements).
+   */
+  double longestEdge() const {
+    double longest = 0.0;
+    for (std::size_t e = 0; e < numElements(); ++e) {
+      const MMatrix M = anisotropyOf(e);
+      for (unsigned int i = 0; i <= PHDIM; ++i) {
+        for (unsigned int j = i + 1; j <= PHDIM; ++j) {
+          const Point edge = points[elements[e][j]] - points[elements[e][i]];
+          longest = std::max(longest, std::sqrt(edge.dot(M * edge)));
+        }
+      }
+    }
+    return longest;
+  }
+
+  /**
+   * @brief A lower bound of the travel time along any segment over its
+   * euclidean length: the square root of the smallest eigenvalue of the
+   * anisotropy, over all the elements.
+   *
+   * Computed on each call, in O(number of elements).
+   */
+  double slownessBound() const {
+    double smallest = std::numeric_limits<double>::infinity();
+    const std::size_t count = isUniform() ? 1 : tensors.size();
+    for (std::size_t e = 0; e < count; ++e) {
+      const Eigen::SelfAdjointEigenSolver<MMatrix> solver(
+          anisotropyOf(e), Eigen::EigenvaluesOnly);
+      smallest = std::min(smallest, solver.eigenvalues()[0]);
+    }
+    return std::sqrt(std::max(smallest, 0.0));
+  }
+
+  /**
+   * @brief Move the coordinates and the adjacency rows of every node id to
+   * the NUMA node of the thread owning the id (see
+   * Eikonal::numa::placeByPartition()); the content is not changed.
+   *
+   * Called by ParallelEikonalSolver::setNumaMode(). Solvers sharing the
+   * geometry share its placement: the last call wins.
+   */
+  void placeByPartition(const std::vector<int> &thread_node) const {
+    Eikonal::numa::placeByPartition(points, thread_node);
+    adjacency.placeByPartition(thread_node);
+  }
+
+private:
+  void build(const std::vector<Mesh_element<PHDIM>> &mesh) {
+    adjacency.build(mesh);
+    bounds.build(mesh, [this](std::size_t e) { return anisotropyOf(e); });
+    // The coordinates are first touched by the threads owning their ids
+    Eikonal::numa::firstTouch(points, adjacency.size(), [this](std::size_t id) {
+      const auto &node = adjacency.node(id);
+      return node ? Point(node->p) : Point(Point::Zero());
+    });
+    elements.resize(mesh.size());
+    const long num_elements = static_cast<long>(mesh.size());
+#pragma omp parallel for schedule(static) default(shared)
+    for (long e = 0; e < num_elements; ++e) {
+      for (unsigned int k = 0; k <= PHDIM; ++k) {
+        elements[e][k] = mesh[e].vertex[k]->id;
+      }
+    }
+  }
+
+  MMatrix anisotropy;
+  //! The compact anisotropy of a uniform mesh.
+  Tensor<PHDIM> uniformTensor{};
+  //! The anisotropy of every element, empty if uniform.
+  std::vector<Tensor<PHDIM>> tensors;
+  MeshAdjacency<PHDIM> adjacency;
+  LocalProblemBounds<PHDIM> bounds;
+  Eikonal::numa::PartitionedVector<Point> points;
+  std::vector<Element> elements;
+};
+
+} // namespace Eikonal
+
+#endif // MESHGEOMETRY_HPP
@@ -0,0 +1,412 @@
+#ifndef MULTISOURCEEIKONALSOLVER_HPP
+#define MULTISOURCEEIKONALSOLVER_HPP
+
+#include "AtomicUtils.hpp"
+#include "BatchedLocalSolver.hpp"
+#include "EikonalSolver.hpp"
+#include "MeshGeometry.hpp"
+#include "SolverStatistics.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Solves the Eikonal equation from K sources at once.
+ *
+ * Every node carries K values, one per source, stored contiguously (a block
+ * of K doubles per node id). The propagation is the one of
+ * ParallelEikonalSolver::update() run for every source at once: a node is
+ * active while any of its sources is, the adjacency, the coordinates and the
+ * lower bounds are read once for all of them, and the local problems of a
+ * node, for all its elements and active sources, fill the same SIMD batch
+ * (see BatchedLocalSolver.hpp). The local solver is always the batched
+ * closed form.
+ *
+ * The sources gain the most from sharing a traversal when their fronts
+ * cross the same nodes in the same sweeps, i.e. when they are close.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class MultiSourceEikonalSolver {
+  using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
+  using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+
+public:
+  /**
+   * @param geometry The mesh, which may be shared with other solvers.
+   * @param sources The node id of every source: solution k is the travel
+   * time from sources[k].
+   * @throw std::invalid_argument If there are no sources or a source is not
+   * a node of the mesh.
+   */
+  MultiSourceEikonalSolver(
+      std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+      const std::vector<unsigned int> &sources)
+      : geometry(std::move(geometry)),
+        adjacency(this->geometry->getAdjacency()),
+        bounds(this->geometry->getBounds()), sources(sources),
+        K(sources.size()), mat(this->geometry->getAnisotropy()) {
+    if (sources.empty()) {
+      throw std::invalid_argument("A multi-source solve needs a source");
+    }
+    for (auto id : sources) {
+      if (id >= this->geometry->numNodes() || !this->geometry->hasNode(id)) {
+        throw std::invalid_argument("Source node " + std::to_string(id) +
+                                    " is not in the mesh");
+      }
+    }
+    initializeMaps();
+    initialize();
+  }
+
+  /**
+   * @brief Number of sources, K.
+   */
+  std::size_t numSources() const { return K; }
+
+  const std::vector<unsigned int> &getSources() const { return sources; }
+
+  /**
+   * @brief Run the propagation until every value of every node converged.
+   *
+   * Bulk-synchronous sweeps over the active nodes, in parallel; values are
+   * lowered with Eikonal::atomicMin. Only the active sources of a node are
+   * solved, and a source that converged at a node activates it at the
+   * neighbours it lowers, as in ParallelEikonalSolver::update(). The buffers
+   * are sized at construction: a sweep does not allocate.
+   */
+  void update() {
+    // omp_set_num_threads() may have grown the pool since construction
+    growThreadBuffers(omp_get_max_threads());
+    while (!activeList.empty()) {
+      std::atomic<std::size_t> numAdded{0};
+      std::atomic<std::size_t> numRemoved{0};
+      std::atomic<std::size_t> numConverged{0};
+      std::atomic<std::size_t> numStarted{0};
+
+#pragma omp parallel for schedule(dynamic) default(shared)
+      for (std::size_t idx = 0; idx < activeList.size(); ++idx) {
+        const unsigned int id = activeList[idx];
+        auto &buffers = scratch[omp_get_thread_num()];
+        double *best = buffers.best.data();
+
+        std::size_t num_active = 0;
+        for (std::size_t k = 0; k < K; ++k) {
+          if (sourceFlags.test(id * K + k) && !startFlags.test(id * K + k)) {
+            buffers.active[num_active++] = k;
+          }
+        }
+        solveNode(id, buffers.active.data(), num_active, best);
+
+        // A source converged when its value is not lowered by EPSILON or more
+        std::size_t num_converged = 0;
+        for (std::size_t i = 0; i < num_active; ++i) {
+          const std::size_t k = buffers.active[i];
+          double &u = values[id * K + k];
+          const double previous = Eikonal::atomicLoad(u);
+          Eikonal::atomicMin(u, best[k]);
+          if (previous - best[k] < EPSILON) {
+            buffers.converged[num_converged++] = k;
+            toClear[numConverged++] = id * K + k;
+          }
+        }
+        if (num_converged == num_active) {
+          toRemove[numRemoved++] = id;
+        }
+        if (num_converged == 0) {
+          continue;
+        }
+
+        for (auto neighbour : adjacency.neighboursOf(id)) {
+          std::size_t num_probed = 0;
+          for (std::size_t i = 0; i < num_converged; ++i) {
+            const std::size_t k = buffers.converged[i];
+            if (!sourceFlags.test(neighbour * K + k)) {
+              buffers.active[num_probed++] = k;
+            }
+          }
+          if (num_probed == 0) {
+            continue;
+          }
+          solveNode(neighbour, buffers.active.data(), num_probed, best);
+          bool activated = false;
+          for (std::size_t i = 0; i < num_probed; ++i) {
+            const std::size_t k = buffers.active[i];
+            if (Eikonal::atomicMin(values[neighbour * K + k], best[k]) &&
+                sourceFlags.testAndSet(neighbour * K + k)) {
+              startFlags.testAndSet(neighbour * K + k);
+              toStart[numStarted++] = neighbour * K + k;
+              activated = true;
+            }
+          }
+          if (activated && activeFlags.testAndSet(neighbour)) {
+            toAdd[numAdded++] = neighbour;
+          }
+        }
+      }
+
+      // As the active flags, the flags of the converged sources are cleared
+      // after the sweep; a node stays active if a neighbour activated one of
+      // its sources after it was solved
+      for (std::size_t i = 0; i < numConverged; ++i) {
+        sourceFlags.clear(toClear[i]);
+      }
+      for (std::size_t i = 0; i < numStarted; ++i) {
+        startFlags.clear(toStart[i]);
+      }
+      for (std::size_t i = 0; i < numRemoved; ++i) {
+        const unsigned int id = toRemove[i];
+        bool idle = true;
+        for (std::size_t k = 0; k < K && idle; ++k) {
+          idle = !sourceFlags.test(id * K + k);
+        }
+        if (idle) {
+          activeFlags.clear(id);
+        }
+      }
+      activeList.erase(std::remove_if(activeList.begin(), activeList.end(),
+                                      [this](unsigned int id) {
+                                        return !activeFlags.test(id);
+                                      }),
+                       activeList.end());
+      activeList.insert(activeList.end(), toAdd.begin(),
+                        toAdd.begin() + numAdded);
+    }
+  }
+
+  /**
+   * @brief The travel times from sources[k], by node id.
+   */
+  std::vector<double> getValues(std::size_t k) const {
+    std::vector<double> result(geometry->numNodes());
+    for (std::size_t id = 0; id < result.size(); ++id) {
+      result[id] = values[id * K + k];
+    }
+    return result;
+  }
+
+  /**
+   * @brief The travel time of a node from sources[k].
+   */
+  double getValue(std::size_t id, std::size_t k) const {
+    return values[id * K + k];
+  }
+
+  /**
+   * @brief Local problems solved and skipped since construction or the last
+   * resetStatistics(); a solve is one element for one source.
+   */
+  Eikonal::SolverStatistics getStatistics() const {
+    return statistics.total();
+  }
+
+  void resetStatistics() { statistics.reset(); }
+
+private:
+  /**
+   * @brief Scratch buffers of one thread, K entries each.
+   */
+  struct alignas(64) Scratch {
+    std::vector<double> best;
+    //! The active and the converged sources of the node being updated.
+    std::vector<std::size_t> active;
+    std::vector<std::size_t> converged;
+    //! The sources solved on an element, with their base values.
+    std::vector<std::size_t> solved;
+    std::array<std::vector<double>, PHDIM> base;
+    //! The local problems of a node, with the source of each.
+    Eikonal::simd::LocalProblemBatch<PHDIM> batch;
+    std::array<std::size_t, Eikonal::simd::LocalProblemBatch<PHDIM>::capacity>
+        batchSource;
+  };
+
+  std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry;
+  const MeshAdjacency<PHDIM> &adjacency;
+  const Eikonal::LocalProblemBounds<PHDIM> &bounds;
+  std::vector<unsigned int> sources;
+  std::size_t K;
+  const Mat &mat;
+  //! K values per node id, the values of a node contiguous.
+  std::vector<double> values;
+  std::vector<unsigned int> activeList;
+  //! Set for the nodes in activeList.
+  Eikonal::NodeFlags activeFlags;
+  //! Set for the sources still changing at a node, K flags per node id.
+  Eikonal::NodeFlags sourceFlags;
+  //! Nodes activated and converged during a sweep.
+  std::vector<unsigned int> toAdd;
+  std::vector<unsigned int> toRemove;
+  //! Flags of the sources converged during a sweep, as id * K + k.
+  std::vector<std::size_t> toClear;
+  //! Sources activated during a sweep, solved from the next one as in
+  //! ParallelEikonalSolver, with their flags.
+  std::vector<std::size_t> toStart;
+  Eikonal::NodeFlags startFlags;
+  std::vector<Scratch> scratch;
+  Eikonal::StatisticsCounters statistics;
+
+  /**
+   * @brief Size the values, the flags and the buffers of update(), which
+   * can hold every node and every source at once.
+   */
+  void initializeMaps() {
+    const std::size_t num_ids = geometry->numNodes();
+    values.assign(num_ids * K, INF);
+    activeFlags.resize(num_ids);
+    sourceFlags.resize(num_ids * K);
+    startFlags.resize(num_ids * K);
+    activeList.reserve(num_ids);
+    toAdd.resize(num_ids);
+    toRemove.resize(num_ids);
+    toClear.resize(num_ids * K);
+    toStart.resize(num_ids * K);
+    statistics.resize(omp_get_max_threads());
+    growThreadBuffers(omp_get_max_threads());
+  }
+
+  /**
+   * @brief At least one scratch and one statistics slot per thread of a pool
+   * of num_threads; allocates only when the pool grew.
+   */
+  void growThreadBuffers(std::size_t num_threads) {
+    statistics.grow(num_threads);
+    if (scratch.size() >= num_threads) {
+      return;
+    }
+    const std::size_t first = scratch.size();
+    scratch.resize(num_threads);
+    for (std::size_t t = first; t < num_threads; ++t) {
+      auto &buffers = scratch[t];
+      buffers.best.resize(K);
+      buffers.active.resize(K);
+      buffers.converged.resize(K);
+      buffers.solved.resize(K);
+      for (auto &base : buffers.base) {
+        base.resize(K);
+      }
+    }
+  }
+
+  /**
+   * @brief Zero at every source, for its own solution; the initial frontier
+   * is made of the neighbours of every source, active for that source.
+   */
+  void initialize() {
+    for (std::size_t k = 0; k < K; ++k) {
+      values[sources[k] * K + k] = 0.0;
+      for (auto neighbour : adjacency.neighboursOf(sources[k])) {
+        sourceFlags.testAndSet(neighbour * K + k);
+        if (activeFlags.testAndSet(neighbour)) {
+          activeList.push_back(neighbour);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief The smallest local solution around a node for the given
+   * sources, or its current value if none is lower.
+   *
+   * For every element, only the sources whose lower bound (see
+   * Eikonal::LocalProblemBounds) is below the current value, with a base
+   * not all INF, are solved; the element is skipped if there are none.
+   *
+   * @param selected The indices of the sources to solve.
+   * @param best The K values, set for the given sources only.
+   */
+  void solveNode(unsigned int id, const std::size_t *selected,
+                 std::size_t num_selected, double *best) {
+    auto &buffers = scratch[omp_get_thread_num()];
+    auto &stats = statistics.local();
+    for (std::size_t i = 0; i < num_selected; ++i) {
+      const std::size_t k = selected[i];
+      best[k] = Eikonal::atomicLoad(values[id * K + k]);
+    }
+
+    for (auto e : adjacency.elementsOf(id)) {
+      // The base vertices in element order, as in the other solvers
+      std::array<unsigned int, PHDIM> base;
+      double node_distance = 0.0;
+      unsigned int count = 0;
+      const auto &vertices = geometry->element(e);
+      for (unsigned int v = 0; v <= PHDIM; ++v) {
+        if (vertices[v] == id) {
+          node_distance = bounds.distanceOf(e, v);
+        } else if (count < PHDIM) {
+          base[count++] = vertices[v];
+        }
+      }
+      if (count < PHDIM) {
+        continue;
+      }
+
+      bool reached = false;
+      std::size_t num_solved = 0;
+      for (std::size_t i = 0; i < num_selected; ++i) {
+        const std::size_t k = selected[i];
+        double base_min = INF;
+        for (unsigned int v = 0; v < PHDIM; ++v) {
+          const double value = Eikonal::atomicLoad(values[base[v] * K + k]);
+          buffers.base[v][num_solved] = value;
+          base_min = std::min(base_min, value);
+        }
+        reached = reached || base_min < INF;
+        if (base_min < INF && base_min + node_distance < best[k]) {
+          buffers.solved[num_solved++] = k;
+        }
+      }
+      if (!reached) {
+        ++stats.skippedInfinite;
+        continue;
+      }
+      if (num_solved == 0) {
+        ++stats.skippedBound;
+        continue;
+      }
+
+      std::array<Point, PHDIM + 1> points;
+      for (unsigned int v = 0; v < PHDIM; ++v) {
+        points[v] = geometry->point(base[v]);
+      }
+      points[PHDIM] = geometry->point(id);
+      stats.localSolves += num_solved;
+      for (std::size_t i = 0; i < num_solved; ++i) {
+        std::array<double, PHDIM> base_values;
+        for (unsigned int v = 0; v < PHDIM; ++v) {
+          base_values[v] = buffers.base[v][i];
+        }
+        buffers.batchSource[buffers.batch.size] = buffers.solved[i];
+        if (geometry->isUniform()) {
+          buffers.batch.add(points, base_values);
+        } else {
+          buffers.batch.add(points, base_values, geometry->tensorOf(e));
+        }
+        if (buffers.batch.full()) {
+          solveBatch(buffers, best);
+        }
+      }
+    }
+    solveBatch(buffers, best);
+  }
+
+  /**
+   * @brief Solve the batch of a thread and lower the values of best with
+   * its results.
+   */
+  void solveBatch(Scratch &buffers, double *best) const {
+    Eikonal::simd::solveBatch(buffers.batch, mat);
+    for (std::size_t i = 0; i < buffers.batch.size; ++i) {
+      const std::size_t k = buffers.batchSource[i];
+      best[k] = std::min(best[k], buffers.batch.result[i]);
+    }
+    buffers.batch.clear();
+  }
+};
+
+#endif // MULTISOURCEEIKONALSOLVER_HPP
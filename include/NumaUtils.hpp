@@ -0,0 +1,318 @@
+#ifndef NUMAUTILS_HPP
+#define NUMAUTILS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef EIKONAL_HAVE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+/**
+ * @brief NUMA placement helpers for the parallel solver.
+ *
+ * The arrays indexed by node id are allocated without being written
+ * (PartitionedVector) and filled by the threads that own their partitions
+ * (firstTouch()), so that under the default first-touch policy each
+ * partition lands on the memory of its thread. With libnuma
+ * (EIKONAL_HAVE_LIBNUMA, set by CMake when the library is found) pages
+ * already placed are also moved to the NUMA node of their thread
+ * (placeByPartition()); without it threads are still pinned on Linux and
+ * memory stays where it was first touched.
+ */
+namespace Eikonal::numa {
+
+/**
+ * @brief Whether the system exposes NUMA nodes through libnuma.
+ */
+inline bool available() {
+#ifdef EIKONAL_HAVE_LIBNUMA
+  return numa_available() >= 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief NUMA node of a cpu, 0 if unknown.
+ */
+inline int nodeOfCpu(int cpu) {
+#ifdef EIKONAL_HAVE_LIBNUMA
+  if (available() && cpu >= 0) {
+    return std::max(numa_node_of_cpu(cpu), 0);
+  }
+#endif
+  (void)cpu;
+  return 0;
+}
+
+/**
+ * @brief The cpus the calling thread may run on, in increasing order.
+ */
+inline std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return cpus;
+}
+
+/**
+ * @brief The cpus the process could run on before any thread was pinned:
+ * those of the first call, which pinOpenMPThreads() makes before pinning.
+ */
+inline const std::vector<int> &processCpus() {
+  static const std::vector<int> cpus = allowedCpus();
+  return cpus;
+}
+
+/**
+ * @brief Let the calling thread run on any of a set of cpus.
+ *
+ * @return false if pinning is not supported or failed.
+ */
+inline bool pinThread(const std::vector<int> &cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+/**
+ * @brief Pin the calling thread to a cpu.
+ *
+ * @return false if pinning is not supported or failed.
+ */
+inline bool pinThread(int cpu) { return pinThread(std::vector<int>{cpu}); }
+
+/**
+ * @brief Pin OpenMP thread t to the t-th allowed cpu (compact placement).
+ *
+ * The runtime keeps the same threads for later regions of the same size, so
+ * it is enough to do it once.
+ *
+ * @return The NUMA node of every thread.
+ */
+inline std::vector<int> pinOpenMPThreads() {
+  const std::vector<int> &cpus = processCpus();
+  std::vector<int> thread_node(omp_get_max_threads(), 0);
+  if (cpus.empty()) {
+    return thread_node;
+  }
+#pragma omp parallel
+  {
+    const int tid = omp_get_thread_num();
+    const int cpu = cpus[tid % cpus.size()];
+    pinThread(cpu);
+    thread_node[tid] = nodeOfCpu(cpu);
+  }
+  return thread_node;
+}
+
+/**
+ * @brief Undo pinOpenMPThreads(): every OpenMP thread may run again on all
+ * the cpus of the process.
+ */
+inline void unpinOpenMPThreads() {
+  const std::vector<int> &cpus = processCpus();
+  if (cpus.empty()) {
+    return;
+  }
+#pragma omp parallel
+  pinThread(cpus);
+}
+
+/**
+ * @brief Move the pages inside [first, last) to a NUMA node (mbind with
+ * MPOL_MF_MOVE); pages partly outside the range stay where they are.
+ * No-op without libnuma.
+ */
+inline void moveToNode(const void *first, const void *last, int node) {
+#ifdef EIKONAL_HAVE_LIBNUMA
+  if (!available()) {
+    return;
+  }
+  const auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+  const std::uintptr_t begin =
+      (reinterpret_cast<std::uintptr_t>(first) + page - 1) / page * page;
+  const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(last) / page * page;
+  if (end <= begin) {
+    return;
+  }
+  struct bitmask *mask = numa_allocate_nodemask();
+  numa_bitmask_setbit(mask, static_cast<unsigned int>(node));
+  // Preferred rather than bound, so that the heap pages, once freed and
+  // reused, may still come from any node
+  mbind(reinterpret_cast<void *>(begin), end - begin, MPOL_PREFERRED,
+        mask->maskp, mask->size + 1, MPOL_MF_MOVE);
+  numa_free_nodemask(mask);
+#else
+  (void)first;
+  (void)last;
+  (void)node;
+#endif
+}
+
+/**
+ * @brief First node id of partition p when num_ids ids are split in
+ * contiguous blocks over num_partitions threads; partition p holds the ids
+ * from partitionBegin(p) to partitionBegin(p + 1).
+ */
+inline std::size_t partitionBegin(int p, std::size_t num_ids,
+                                  int num_partitions) {
+  return static_cast<std::size_t>(p) * num_ids /
+         static_cast<std::size_t>(num_partitions);
+}
+
+/**
+ * @brief Partition that owns a node id: the p with partitionBegin(p) <= id <
+ * partitionBegin(p + 1).
+ */
+inline int ownerOf(std::size_t id, std::size_t num_ids, int num_partitions) {
+  const std::size_t P = static_cast<std::size_t>(num_partitions);
+  return static_cast<int>(((id + 1) * P - 1) / std::max<std::size_t>(num_ids, 1));
+}
+
+/**
+ * @brief An allocator that leaves the elements of a trivial type unwritten
+ * when they are added without a value, so that a vector can be sized
+ * without touching its pages.
+ */
+template <typename T> struct FirstTouchAllocator : std::allocator<T> {
+  template <typename U> struct rebind {
+    using other = FirstTouchAllocator<U>;
+  };
+
+  FirstTouchAllocator() = default;
+  template <typename U>
+  FirstTouchAllocator(const FirstTouchAllocator<U> &) noexcept {}
+
+  template <typename U>
+  void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    ::new (static_cast<void *>(ptr)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U *ptr, Args &&...args) {
+    ::new (static_cast<void *>(ptr)) U(std::forward<Args>(args)...);
+  }
+};
+
+/**
+ * @brief A vector of data by node id (or by CSR row): sized without being
+ * written, for firstTouch() to fill by partition.
+ */
+template <typename T>
+using PartitionedVector = std::vector<T, FirstTouchAllocator<T>>;
+
+/**
+ * @brief Give items new storage for num_ids ids and write value(id) at
+ * every id from the thread owning it: thread p of a parallel region fills
+ * the ids from partitionBegin(p) to partitionBegin(p + 1), so its pages are
+ * first touched, and placed, by that thread.
+ */
+template <typename T, typename Value>
+void firstTouch(PartitionedVector<T> &items, std::size_t num_ids,
+                const Value &value) {
+  items = PartitionedVector<T>(num_ids);
+#pragma omp parallel default(shared)
+  {
+    const int p = omp_get_thread_num();
+    const int num_partitions = omp_get_num_threads();
+    const std::size_t last = partitionBegin(p + 1, num_ids, num_partitions);
+    for (std::size_t id = partitionBegin(p, num_ids, num_partitions); id < last;
+         ++id) {
+      items[id] = value(id);
+    }
+  }
+}
+
+/**
+ * @brief Give the entries of a CSR array new storage, as many as
+ * offsets.back(), set to T{} by the threads owning their rows (see
+ * firstTouch()); offsets has one entry per id plus one.
+ */
+template <typename T>
+void firstTouchRows(PartitionedVector<T> &entries,
+                    const PartitionedVector<std::size_t> &offsets) {
+  const std::size_t num_ids = offsets.empty() ? 0 : offsets.size() - 1;
+  entries = PartitionedVector<T>(num_ids > 0 ? offsets[num_ids] : 0);
+  if (num_ids == 0) {
+    return;
+  }
+#pragma omp parallel default(shared)
+  {
+    const int p = omp_get_thread_num();
+    const int num_partitions = omp_get_num_threads();
+    const std::size_t last =
+        offsets[partitionBegin(p + 1, num_ids, num_partitions)];
+    for (std::size_t k = offsets[partitionBegin(p, num_ids, num_partitions)];
+         k < last; ++k) {
+      entries[k] = T{};
+    }
+  }
+}
+
+/**
+ * @brief Move an array indexed by node id to the memory of the threads
+ * owning the ids: the items of partition p (see partitionBegin()) go to the
+ * NUMA node thread_node[p].
+ */
+template <typename T, typename Allocator>
+void placeByPartition(const std::vector<T, Allocator> &items,
+                      const std::vector<int> &thread_node) {
+  const int num_partitions = static_cast<int>(thread_node.size());
+  for (int p = 0; p < num_partitions; ++p) {
+    moveToNode(items.data() + partitionBegin(p, items.size(), num_partitions),
+               items.data() + partitionBegin(p + 1, items.size(), num_partitions),
+               thread_node[p]);
+  }
+}
+
+/**
+ * @brief Move the rows of a CSR array to the memory of the threads owning
+ * their node ids; offsets has one entry per id plus one.
+ */
+template <typename T>
+void placeByPartition(const PartitionedVector<T> &entries,
+                      const PartitionedVector<std::size_t> &offsets,
+                      const std::vector<int> &thread_node) {
+  const int num_partitions = static_cast<int>(thread_node.size());
+  const std::size_t num_ids = offsets.empty() ? 0 : offsets.size() - 1;
+  for (int p = 0; p < num_partitions && num_ids > 0; ++p) {
+    moveToNode(entries.data() + offsets[partitionBegin(p, num_ids, num_partitions)],
+               entries.data() + offsets[partitionBegin(p + 1, num_ids, num_partitions)],
+               thread_node[p]);
+  }
+}
+
+} // namespace Eikonal::numa
+
+#endif // NUMAUTILS_HPP
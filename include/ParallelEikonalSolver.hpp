@@ -1,18 +1,46 @@
 #ifndef PARALLELEIKONALSOLVER_HPP
 #define PARALLELEIKONALSOLVER_HPP
 
+#include "AtomicUtils.hpp"
+#include "BatchedLocalSolver.hpp"
+#include "BoundaryConditions.hpp"
+#include "ChangeSet.hpp"
+#include "Diagnostics.hpp"
 #include "EikonalSolver.hpp"
+#include "LambdaCache.hpp"
+#include "LocalProblemBounds.hpp"
+#include "LocalSolutionCache.hpp"
+#include "LocalSolverEngine.hpp"
+#include "MeshAdjacency.hpp"
 #include "MeshElement.hpp"
-#include "solveEikonalLocalProblem.hpp"
+#include "MeshGeometry.hpp"
+#include "NumaUtils.hpp"
+#include "SolveState.hpp"
+#include "SolverStatistics.hpp"
+#include "SourceLabels.hpp"
+#include "StoppingCriteria.hpp"
+#include "ToleranceSchedule.hpp"
+#include "solveEikonalLocalProblemAnalytic.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <omp.h>
-#include <unordered_map>
-#include <unordered_set>
+#include <string>
+#include <thread>
 #include <vector>
 
+/**
+ * @brief Level at which ParallelEikonalSolver spreads the work over threads.
+ */
+enum class ParallelGranularity {
+  Nodes,    //!< Across the frontier nodes, each local solve is serial.
+  Elements, //!< Across the elements around a node, the frontier is serial.
+  Hybrid    //!< Across nodes for large frontiers, across elements otherwise.
+};
+
 /**
  * @brief Parallel solver for the Eikonal equation using OpenMP.
  *
@@ -20,108 +48,585 @@
  */
 template <unsigned int PHDIM> class ParallelEikonalSolver {
   using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+  using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
+  using VectorExt = typename Eikonal::Eikonal_traits<PHDIM>::VectorExt;
+  using Lambda = typename Eikonal::Eikonal_traits<PHDIM>::Vector;
 
 public:
   /**
    * @brief Construct a new Parallel Eikonal Solver.
    *
+   * The geometry of the mesh is copied into a MeshGeometry of its own, the
+   * sources are the nodes flagged isSource, and the values are written back
+   * to the nodes (Node::u) at construction and after every update.
+   *
    * @param mesh Reference to the mesh elements.
    * @param matrix Reference to the matrix used in calculations.
+   * @param granularity Level of parallelism, see setGranularity().
    */
-  ParallelEikonalSolver(std::vector<Mesh_element<PHDIM>> &mesh, Mat &matrix)
-      : mesh(mesh), mat(matrix) {
+  ParallelEikonalSolver(
+      std::vector<Mesh_element<PHDIM>> &mesh, Mat &matrix,
+      ParallelGranularity granularity = ParallelGranularity::Nodes)
+      : ParallelEikonalSolver(
+            std::make_shared<const Eikonal::MeshGeometry<PHDIM>>(mesh, matrix),
+            sourcesOf(mesh), granularity) {
+    publishToNodes = true;
+    publish();
+  }
+
+  /**
+   * @brief Construct a solver on a shared mesh.
+   *
+   * The geometry is only read, so several solvers, with their own sources
+   * and options, may share it and run at the same time. The values are kept
+   * in the solver, see getValues().
+   *
+   * @param geometry The mesh.
+   * @param sources The node ids of the sources.
+   * @param granularity Level of parallelism, see setGranularity().
+   * @throw std::invalid_argument If a source is not a node of the mesh.
+   */
+  ParallelEikonalSolver(
+      std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+      const std::vector<unsigned int> &sources,
+      ParallelGranularity granularity = ParallelGranularity::Nodes)
+      : geometry(std::move(geometry)),
+        adjacency(this->geometry->getAdjacency()),
+        bounds(this->geometry->getBounds()),
+        mat(this->geometry->getAnisotropy()), granularity(granularity) {
+    state.resize(this->geometry->numNodes(), INF);
+    state.setSources(sources);
     initializeMaps();
     initialize();
   }
 
+  /**
+   * @brief Construct a solver on a shared mesh from boundary values: every
+   * node given is a source with its own starting time, e.g. the vertices
+   * around a point source (see Eikonal::pointSource()) or a POINT_DATA
+   * field of the input file (see Eikonal::boundaryValuesOf()).
+   *
+   * @param geometry The mesh.
+   * @param boundary The sources and their times.
+   * @param granularity Level of parallelism, see setGranularity().
+   * @throw std::invalid_argument If a node is not in the mesh or a time is
+   * not finite.
+   */
+  ParallelEikonalSolver(
+      std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+      const Eikonal::BoundaryConditions &boundary,
+      ParallelGranularity granularity = ParallelGranularity::Nodes)
+      : geometry(std::move(geometry)),
+        adjacency(this->geometry->getAdjacency()),
+        bounds(this->geometry->getBounds()),
+        mat(this->geometry->getAnisotropy()), granularity(granularity) {
+    state.resize(this->geometry->numNodes(), INF);
+    state.setBoundaryValues(boundary.values);
+    initializeMaps();
+    initialize();
+  }
+
+  /**
+   * @brief Construct a solver that continues a previous solve after a
+   * change, e.g. on a mesh with the speed changed in a region.
+   *
+   * The values and the sources are those of previous, with the changes
+   * applied as by applyChanges(); update() then recomputes the region they
+   * affect only.
+   *
+   * @param geometry The mesh: the one of the previous solve, or one with the
+   * same nodes and elements.
+   * @param previous The state of a converged solve, see getState().
+   * @param changes The changes since the previous solve.
+   * @param granularity Level of parallelism, see setGranularity().
+   * @throw std::invalid_argument If previous is not a state of this mesh or
+   * the changes are not valid.
+   */
+  ParallelEikonalSolver(
+      std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry,
+      const Eikonal::SolveState &previous, const Eikonal::ChangeSet &changes,
+      ParallelGranularity granularity = ParallelGranularity::Nodes)
+      : geometry(std::move(geometry)),
+        adjacency(this->geometry->getAdjacency()),
+        bounds(this->geometry->getBounds()),
+        mat(this->geometry->getAnisotropy()), state(previous),
+        granularity(granularity) {
+    if (state.size() != this->geometry->numNodes()) {
+      throw std::invalid_argument("The previous solve has " +
+                                  std::to_string(state.size()) +
+                                  " nodes, the mesh " +
+                                  std::to_string(this->geometry->numNodes()));
+    }
+    initializeMaps();
+    applyChanges(changes);
+  }
+
+  /**
+   * @brief Prepare the next update after sources were added or removed, or
+   * the speed of some elements changed, since the last one.
+   *
+   * Only the nodes the changes may affect are reset (see
+   * Eikonal::applyChanges()), and the next update(), or updateAsync(),
+   * propagates from the boundary of that region, at a cost proportional to
+   * its size. The values must have converged.
+   *
+   * @throw std::invalid_argument If the changes are not valid; nothing is
+   * changed then.
+   */
+  void applyChanges(const Eikonal::ChangeSet &changes) {
+    auto solve = [this](unsigned int id) {
+      bool approximate;
+      return solveLocal(id, approximate);
+    };
+    for (auto id :
+         Eikonal::applyChanges(*geometry, state, changes, INF, EPSILON, solve)) {
+      if (activeFlags.testAndSet(id)) {
+        activeList.push_back(id);
+      }
+    }
+  }
+
+  /**
+   * @brief Choose the level at which the work is spread over threads.
+   *
+   * Only one level is ever parallel, so there are no nested regions. With
+   * Hybrid, a sweep of update() runs across nodes when the frontier holds at
+   * least cutoff nodes and across the elements of each node otherwise.
+   * updateAsync() always works across nodes.
+   *
+   * @param policy The parallelization level.
+   * @param cutoff Frontier size for Hybrid; 0 means the number of threads.
+   */
+  void setGranularity(ParallelGranularity policy, std::size_t cutoff = 0) {
+    granularity = policy;
+    this->cutoff = cutoff;
+  }
+
+  ParallelGranularity getGranularity() const { return granularity; }
+
+  /**
+   * @brief Enable or disable the NUMA mode.
+   *
+   * Threads are pinned (see Eikonal::numa::pinOpenMPThreads) and node ids
+   * are split in one contiguous partition per thread. The values, the source
+   * flags, and the coordinates and adjacency rows of the geometry are always
+   * first touched by partition when they are built (see
+   * Eikonal::numa::firstTouch), so their pages land where the threads that
+   * own them run. With libnuma, pages that were placed before the threads
+   * were pinned are then moved to the NUMA node of their thread (see
+   * Eikonal::numa::placeByPartition). Both engines give each thread the active
+   * nodes of its own partition first, then those of partitions on the same
+   * NUMA node, and only then the remote ones. Disabling the mode unpins the
+   * threads (see Eikonal::numa::unpinOpenMPThreads): they are the OpenMP
+   * threads of the process, shared with any other solver in NUMA mode.
+   */
+  void setNumaMode(bool enable) {
+    if (enable) {
+      threadNode = Eikonal::numa::pinOpenMPThreads();
+      geometry->placeByPartition(threadNode);
+      Eikonal::numa::placeByPartition(state.u, threadNode);
+      Eikonal::numa::placeByPartition(state.isSource, threadNode);
+      partitionOrder = stealOrder(numPartitions());
+      partitionRange.resize(numPartitions() + 1);
+      partitionNext = std::vector<std::atomic<std::size_t>>(numPartitions());
+      asyncQueues.clear();
+      prepareQueues();
+    } else if (isNumaMode()) {
+      Eikonal::numa::unpinOpenMPThreads();
+      threadNode.clear();
+      partitionOrder.clear();
+      asyncQueues.clear();
+      prepareQueues();
+    }
+  }
+
+  bool isNumaMode() const { return !threadNode.empty(); }
+
+  /**
+   * @brief Choose the solver of the local problems (projected Newton or
+   * closed form), Eikonal::defaultLocalSolver unless set.
+   */
+  void setLocalSolver(Eikonal::LocalSolverType type) {
+    localSolver = type;
+    engine.reset();
+    // The cached solutions came from the previous local solver
+    solutionCache.clear();
+  }
+
+  /**
+   * @brief Choose the solver of the local problems by name, among those of
+   * Eikonal::LocalSolverEngineFactory.
+   *
+   * The built-in solvers keep their own code path (batches, no virtual
+   * calls); the other engines are called through the factory product.
+   *
+   * @throw std::invalid_argument If there is no engine with that name.
+   */
+  void setLocalSolver(const std::string &name) {
+    std::shared_ptr<const Eikonal::LocalSolverEngine<PHDIM>> created =
+        Eikonal::makeLocalSolverEngine<PHDIM>(name);
+    setLocalSolver(created->type());
+    if (localSolver == Eikonal::LocalSolverType::LineSearch) {
+      engine = std::move(created);
+    }
+  }
+
+  Eikonal::LocalSolverType getLocalSolver() const { return localSolver; }
+
+  /**
+   * @brief Tolerances and iteration limits of the iterative local solvers,
+   * the defaults of Eikonal::LocalSolverOptions unless set.
+   *
+   * They belong to this solver only, so solvers with different options may
+   * run at the same time (on different meshes). Not to be changed during
+   * update().
+   */
+  void setLocalSolverOptions(const Eikonal::LocalSolverOptions &options) {
+    localOptions = options;
+    // The cached solutions were computed with the previous options
+    solutionCache.clear();
+  }
+
+  const Eikonal::LocalSolverOptions &getLocalSolverOptions() const {
+    return localOptions;
+  }
+
+  /**
+   * @brief Enable or disable the adaptive tolerances of the iterative local
+   * solvers.
+   *
+   * When enabled, the local solves of a node use a tolerance proportional to
+   * the last change of its value (see Eikonal::ToleranceSchedule): loose
+   * while the value is far from final, schedule.accuracy at the end. A node
+   * is declared converged only after a solve at schedule.accuracy, which
+   * replaces the tolerances of setLocalSolverOptions(). The closed-form
+   * solvers are not affected.
+   */
+  void setToleranceSchedule(bool enable,
+                            const Eikonal::ToleranceSchedule &schedule = {}) {
+    if (enable) {
+      tolerances.enable(adjacency.size(), schedule);
+    } else {
+      tolerances.disable();
+    }
+    solutionCache.clear();
+  }
+
+  bool isToleranceSchedule() const { return tolerances.enabled(); }
+
+  /**
+   * @brief Let the next updates stop before every node is reached.
+   *
+   * Nodes beyond the travel time or the targets of the criteria, or out of
+   * their region, are never activated, and are left unreached (INF, see
+   * isReached()) at the end of the update; the other values are those of a
+   * full solve, along paths in the region if there is one. See
+   * Eikonal::EarlyTermination.
+   *
+   * @throw std::invalid_argument If a target is not a node of the mesh.
+   */
+  void setStoppingCriteria(const Eikonal::StoppingCriteria<PHDIM> &criteria) {
+    termination.enable(criteria, *geometry);
+  }
+
+  /**
+   * @brief Run the next updates until every node is reached.
+   */
+  void clearStoppingCriteria() { termination.disable(); }
+
+  /**
+   * @brief Whether a node has a value: false for the nodes left out by the
+   * stopping criteria and for those no source reaches.
+   */
+  bool isReached(std::size_t id) const { return state.u[id] < INF; }
+
+  /**
+   * @brief Local problems solved and skipped since construction or the last
+   * resetStatistics(), summed over the threads.
+   */
+  Eikonal::SolverStatistics getStatistics() const {
+    return statistics.total();
+  }
+
+  void resetStatistics() { statistics.reset(); }
+
+  /**
+   * @brief Enable or disable the warm start of the Newton local solver.
+   *
+   * When enabled, every (node, element) pair remembers the lambda of its
+   * last solve (see Eikonal::LambdaCache) and the next Newton solve starts
+   * from it instead of the centre of the base. The cache is allocated here,
+   * not during update().
+   */
+  void setWarmStart(bool enable) {
+    lambdaCache.resize(enable ? adjacency.numElementSlots() : 0);
+  }
+
+  bool isWarmStart() const { return !lambdaCache.empty(); }
+
+  /**
+   * @brief Enable or disable the cache of the local solutions.
+   *
+   * When enabled, every (node, element) pair remembers its last solution and
+   * the values at the base it came from (see Eikonal::LocalSolutionCache);
+   * solving the pair again with the same values returns it without running
+   * the local solver. The batched local solver does not use it. The cache is
+   * allocated here, not during update().
+   */
+  void setSolutionCache(bool enable) {
+    solutionCache.resize(enable ? adjacency.numElementSlots() : 0);
+  }
+
+  bool isSolutionCache() const { return !solutionCache.empty(); }
+
   /**
    * @brief Update the solution of the Eikonal equation.
+   *
+   * Bulk-synchronous engine: every sweep solves the whole active list in
+   * parallel. Values are lowered with Eikonal::atomicMin and neighbours are
+   * activated through the active flags, so each node enters the list once.
+   * All the buffers are sized at construction: a sweep does not allocate.
+   */
+  void update() {
+    // omp_set_num_threads() may have grown the pool since construction
+    statistics.grow(omp_get_max_threads());
+    while (!activeList.empty()) {
+      std::atomic<std::size_t> numAdded{0};
+      std::atomic<std::size_t> numRemoved{0};
+
+      const bool parallel_nodes = parallelOverNodes(activeList.size());
+      const double limit = termination.threshold(state.u);
+
+      auto sweep = [&](size_t idx) {
+        int node_id = activeList[idx];
+        if (!termination.inside(node_id)) {
+          toRemove[numRemoved++] = node_id;
+          return;
+        }
+
+        bool approximate;
+        double previous_value = Eikonal::atomicLoad(state.u[node_id]);
+        double new_u = solveLocal(node_id, approximate);
+        Eikonal::atomicMin(state.u[node_id], new_u);
+        // A node reached for the first time has no change to record
+        if (previous_value < INF) {
+          tolerances.record(node_id, std::max(previous_value - new_u, 0.0));
+        }
+
+        // Values only decrease: a node whose local solve does not lower it
+        // by more than EPSILON is converged, unless the solve was loose.
+        if (previous_value - new_u < EPSILON && !approximate) {
+          for (auto neighbour_id : adjacency.neighboursOf(node_id)) {
+            if (state.isSource[neighbour_id] ||
+                activeFlags.test(neighbour_id)) {
+              continue;
+            }
+            double p = Eikonal::atomicLoad(state.u[neighbour_id]);
+            bool neighbour_approximate;
+            double q = solveLocal(neighbour_id, neighbour_approximate);
+            if (p > q && termination.admits(neighbour_id, q, limit) &&
+                Eikonal::atomicMin(state.u[neighbour_id], q) &&
+                activeFlags.testAndSet(neighbour_id)) {
+              if (p < INF) {
+                tolerances.record(neighbour_id, p - q);
+              }
+              toAdd[numAdded++] = neighbour_id;
+              apsc::diagnostics::count(
+                  apsc::diagnostics::Event::NodeActivated);
+            }
+          }
+          toRemove[numRemoved++] = node_id;
+        } else if (new_u > limit) {
+          // Beyond the stopping threshold: reached again by its neighbours
+          // if its value comes down
+          toRemove[numRemoved++] = node_id;
+        }
+      };
+
+      if (isNumaMode()) {
+        sweepByPartition(parallel_nodes, sweep);
+      } else {
+#pragma omp parallel for schedule(dynamic) default(shared) if (parallel_nodes)
+        for (size_t idx = 0; idx < activeList.size(); ++idx) {
+          sweep(idx);
+        }
+      }
+
+      for (std::size_t i = 0; i < numRemoved; ++i) {
+        activeFlags.clear(toRemove[i]);
+      }
+      activeList.erase(std::remove_if(activeList.begin(), activeList.end(),
+                                      [this](int id) {
+                                        return !activeFlags.test(id);
+                                      }),
+                       activeList.end());
+      activeList.insert(activeList.end(), toAdd.begin(),
+                        toAdd.begin() + numAdded);
+    }
+    finish();
+  }
+
+  /**
+   * @brief Update the solution with the asynchronous engine.
+   *
+   * A single parallel region is opened for the whole propagation. Every
+   * thread owns a deque of active nodes: it pops from the back of its own
+   * deque, pushes the neighbours it activates locally and, when idle, steals
+   * from the front of the other deques. A node is never queued twice at the
+   * same time, and the propagation ends when the number of queued or
+   * in-flight nodes drops to zero, so no barrier is needed between sweeps.
+   * The deques are lists linked through per-node arrays sized at
+   * construction, so the engine does not allocate.
    */
- void update()
+  void updateAsync() {
+    statistics.grow(omp_get_max_threads());
+    // The active flags of the nodes in activeList are already set: here
+    // they mark the queued nodes.
+    prepareQueues();
+    const int num_queues = numPartitions();
+    const auto &victims = asyncOrder;
+    auto &queues = asyncQueues;
+    std::atomic<long> pending{static_cast<long>(activeList.size())};
+
+    for (size_t idx = 0; idx < activeList.size(); ++idx) {
+      const int node_id = activeList[idx];
+      const int queue = isNumaMode() ? ownerOf(node_id) : idx % num_queues;
+      pushBack(queues[queue], node_id);
+    }
+    activeList.clear();
+
+#pragma omp parallel default(shared) num_threads(num_queues)
     {
-        while (!activeList.empty())
+      const int tid = omp_get_thread_num();
+
+      // Push a node on a deque and account for it before it becomes
+      // visible, so that pending never drops to zero too early. In NUMA
+      // mode the node goes to the thread owning its partition.
+      auto push = [&](int node_id) {
+        pending.fetch_add(1, std::memory_order_acq_rel);
+        auto &queue = queues[isNumaMode() ? ownerOf(node_id) : tid];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        pushBack(queue, node_id);
+      };
+
+      // Own deque first (LIFO), then steal the oldest node of the others.
+      auto pop = [&](int &node_id) {
         {
-            std::vector<int> toAdd;
-            std::vector<int> toRemove;
-
-            #pragma omp parallel default(shared)
-            {
-                std::vector<int> local_toAdd;
-                std::vector<int> local_toRemove;
-
-                #pragma omp for schedule(dynamic) nowait
-                for (size_t idx = 0; idx < activeList.size(); ++idx)
-                {
-                    int node_id = activeList[idx];
-                    NodePtr<PHDIM> node = nodes[node_id];
-
-                    double previous_value = node->u;
-                    double new_u = solveLocal(*node);
-                    
-                    #pragma omp atomic write
-                    node->u = new_u;
-
-                    if (std::abs(previous_value - new_u) < EPSILON)
-                    {
-                        auto neighbours = getNeighbours(*node);
-                        for (auto& neighbour : neighbours)
-                        {
-                            if (!neighbour->isSource)
-                            {
-                                bool is_active = false;
-                            #pragma omp critical
-                            {
-                                is_active = isInActiveList(*neighbour);
-                            }
-                            if (!is_active && !neighbour->isSource)
-                            {
-                                double p = neighbour->u;
-                                double q = solveLocal(*neighbour);
-
-                                    if (p > q)
-                                    {
-                                        #pragma omp atomic write
-                                        neighbour->u = q;
-                                        local_toAdd.push_back(neighbour->id);
-                                    }
-                                }
-                            }
-                        }
-                        local_toRemove.push_back(node_id);
-                    }
-                }
-
-                #pragma omp critical
-                {
-                    toAdd.insert(toAdd.end(), local_toAdd.begin(), local_toAdd.end());
-                    toRemove.insert(toRemove.end(), local_toRemove.begin(), local_toRemove.end());
-                }
-            }
+          std::lock_guard<std::mutex> lock(queues[tid].mutex);
+          if ((node_id = popBack(queues[tid])) >= 0) {
+            return true;
+          }
+        }
+        for (int k = 1; k < num_queues; ++k) {
+          auto &victim = queues[victims[tid][k]];
+          std::lock_guard<std::mutex> lock(victim.mutex);
+          if ((node_id = popFront(victim)) >= 0) {
+            return true;
+          }
+        }
+        return false;
+      };
+
+      while (pending.load(std::memory_order_acquire) > 0) {
+        int node_id;
+        if (!pop(node_id)) {
+          std::this_thread::yield();
+          continue;
+        }
+
+        // The flag only marks queued nodes: once the node is taken, any
+        // neighbour that converges later may queue it again. The fences pair
+        // this store with the value stores below, otherwise a neighbour
+        // could still see the flag set while we read its old value.
+        activeFlags.clear(node_id);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!termination.inside(node_id)) {
+          pending.fetch_sub(1, std::memory_order_acq_rel);
+          continue;
+        }
+        const double limit = termination.threshold(state.u);
+        bool approximate;
+        double previous_value = Eikonal::atomicLoad(state.u[node_id]);
+        double new_u = solveLocal(node_id, approximate);
+        Eikonal::atomicMin(state.u[node_id], new_u);
+        // A node reached for the first time has no change to record
+        if (previous_value < INF) {
+          tolerances.record(node_id, std::max(previous_value - new_u, 0.0));
+        }
 
-            #pragma omp single
-            {
-                for (const auto& id : toRemove)
-                {
-                    activeList.erase(std::remove(activeList.begin(), activeList.end(), id), activeList.end());
-                }
-                for (const auto& id : toAdd)
-                {
-                    activeList.push_back(id);
-                }
+        // Values only decrease here: a node whose local solve does not
+        // lower it by more than EPSILON is converged, unless the solve was
+        // loose.
+        if (previous_value - new_u < EPSILON && !approximate) {
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          for (auto neighbour_id : adjacency.neighboursOf(node_id)) {
+            if (state.isSource[neighbour_id] ||
+                activeFlags.test(neighbour_id)) {
+              continue;
+            }
+            double p = Eikonal::atomicLoad(state.u[neighbour_id]);
+            bool neighbour_approximate;
+            double q = solveLocal(neighbour_id, neighbour_approximate);
+            if (p > q && termination.admits(neighbour_id, q, limit) &&
+                Eikonal::atomicMin(state.u[neighbour_id], q) &&
+                activeFlags.testAndSet(neighbour_id)) {
+              if (p < INF) {
+                tolerances.record(neighbour_id, p - q);
+              }
+              push(neighbour_id);
+              apsc::diagnostics::count(
+                  apsc::diagnostics::Event::NodeActivated);
             }
+          }
+        } else if (new_u <= limit && activeFlags.testAndSet(node_id)) {
+          push(node_id);
         }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+      }
     }
+    finish();
+  }
 
   /**
    * @brief Print the results of the computation.
    */
   void printResults() const {
-    for (const auto &pair : nodes) {
-      std::cout << "Node " << pair.second->id << ": u = " << pair.second->u
-                << std::endl;
+    for (std::size_t id = 0; id < state.size(); ++id) {
+      if (geometry->hasNode(id)) {
+        std::cout << "Node " << id << ": u = " << state.u[id] << std::endl;
+      }
     }
   }
 
+  /**
+   * @brief The values of the nodes, by id.
+   */
+  const Eikonal::NodeValues &getValues() const { return state.u; }
+
+  /**
+   * @brief The label of the source every node is reached from first, -1 for
+   * the nodes not reached, see Eikonal::sourceLabels(). The sources given by
+   * id are labelled with their id; the boundary values carry their own
+   * label. Computed on each call, after the update.
+   */
+  std::vector<int> getSourceLabels() const {
+    return Eikonal::sourceLabels(*geometry, state, INF);
+  }
+
+  /**
+   * @brief The values and the sources, to continue the solve after a
+   * change (see the constructor taking a previous state).
+   */
+  const Eikonal::SolveState &getState() const { return state; }
+
+  /**
+   * @brief The mesh the solver works on, to be shared with other solvers.
+   */
+  const std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> &
+  getGeometry() const {
+    return geometry;
+  }
+
   /**
    * @brief Get the neighbours of a given node.
    *
@@ -129,109 +634,515 @@ public:
    * @return std::vector<NodePtr<PHDIM>> Vector of neighbouring node pointers.
    */
   std::vector<NodePtr<PHDIM>> getNeighbours(Node<PHDIM> &node) {
-    std::unordered_set<unsigned int> neighbour_ids;
     std::vector<NodePtr<PHDIM>> neighbours;
-    for (auto &mesh_element : nodeToElements[node.id]) {
-      for (auto &mesh_node : mesh_element.vertex) {
-        if (node.id != mesh_node->id &&
-            neighbour_ids.find(mesh_node->id) == neighbour_ids.end()) {
-          neighbour_ids.insert(mesh_node->id);
-          neighbours.push_back(nodes[mesh_node->id]);
-        }
-      }
+    for (auto neighbour_id : adjacency.neighboursOf(node.id)) {
+      neighbours.push_back(adjacency.node(neighbour_id));
     }
     return neighbours;
   }
 
 private:
-  std::vector<Mesh_element<PHDIM>> &mesh;
-  std::unordered_map<unsigned int, NodePtr<PHDIM>> nodes;
-  std::unordered_map<unsigned int, std::vector<Mesh_element<PHDIM>>>
-      nodeToElements;
+  /**
+   * @brief Deque of active nodes owned by one thread of the async engine:
+   * a list linked through queuedPrev and queuedNext, -1 terminated.
+   */
+  struct alignas(64) WorkQueue {
+    std::mutex mutex;
+    //! Oldest and newest node, -1 if empty.
+    int head = -1;
+    int tail = -1;
+  };
+
+  /**
+   * @brief The deques and steal order of updateAsync(), for the current
+   * number of partitions; allocates only if that number changed.
+   */
+  void prepareQueues() {
+    const int num_queues = numPartitions();
+    if (asyncQueues.size() != static_cast<std::size_t>(num_queues)) {
+      asyncQueues = std::vector<WorkQueue>(num_queues);
+      asyncOrder = stealOrder(num_queues);
+    }
+    for (auto &queue : asyncQueues) {
+      queue.head = queue.tail = -1;
+    }
+  }
+
+  //! Append a node to a deque; the caller holds its mutex.
+  void pushBack(WorkQueue &queue, int node_id) {
+    queuedNext[node_id] = -1;
+    queuedPrev[node_id] = queue.tail;
+    if (queue.tail >= 0) {
+      queuedNext[queue.tail] = node_id;
+    } else {
+      queue.head = node_id;
+    }
+    queue.tail = node_id;
+  }
+
+  //! Take the newest node of a deque, -1 if empty; the caller holds its
+  //! mutex.
+  int popBack(WorkQueue &queue) {
+    const int node_id = queue.tail;
+    if (node_id >= 0) {
+      queue.tail = queuedPrev[node_id];
+      (queue.tail >= 0 ? queuedNext[queue.tail] : queue.head) = -1;
+    }
+    return node_id;
+  }
+
+  //! Take the oldest node of a deque, -1 if empty; the caller holds its
+  //! mutex.
+  int popFront(WorkQueue &queue) {
+    const int node_id = queue.head;
+    if (node_id >= 0) {
+      queue.head = queuedNext[node_id];
+      (queue.head >= 0 ? queuedPrev[queue.head] : queue.tail) = -1;
+    }
+    return node_id;
+  }
+
+  /**
+   * @brief Number of threads (and partitions) used by the engines.
+   */
+  int numPartitions() const {
+    return isNumaMode() ? static_cast<int>(threadNode.size())
+                        : omp_get_max_threads();
+  }
+
+  /**
+   * @brief Partition (thread) owning a node in NUMA mode.
+   */
+  int ownerOf(std::size_t id) const {
+    return Eikonal::numa::ownerOf(id, activeFlags.size(), numPartitions());
+  }
+
+  /**
+   * @brief For every thread, the order in which it visits the partitions:
+   * its own, those on the same NUMA node, then the remote ones.
+   */
+  std::vector<std::vector<int>> stealOrder(int num_threads) const {
+    std::vector<std::vector<int>> order(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      for (int k = 0; k < num_threads; ++k) {
+        order[t].push_back((t + k) % num_threads);
+      }
+      if (isNumaMode()) {
+        std::stable_partition(
+            order[t].begin() + 1, order[t].end(),
+            [&](int other) { return threadNode[other] == threadNode[t]; });
+      }
+    }
+    return order;
+  }
+
+  /**
+   * @brief One sweep of update() in NUMA mode.
+   *
+   * The active list is sorted, so the nodes of each partition form a
+   * contiguous range; every thread claims nodes of its own range first and
+   * then helps with the others in stealOrder().
+   */
+  template <typename Sweep> void sweepByPartition(bool parallel, Sweep &sweep) {
+    const int num_partitions = numPartitions();
+    const auto &order = partitionOrder;
+    auto &range = partitionRange;
+    auto &next = partitionNext;
+
+    std::sort(activeList.begin(), activeList.end());
+    range[num_partitions] = activeList.size();
+    for (int p = num_partitions - 1; p >= 0; --p) {
+      range[p] = std::lower_bound(activeList.begin(), activeList.end(), 0,
+                                  [&](int id, int) { return ownerOf(id) < p; }) -
+                 activeList.begin();
+    }
+    for (int p = 0; p < num_partitions; ++p) {
+      next[p].store(range[p], std::memory_order_relaxed);
+    }
+
+#pragma omp parallel default(shared) num_threads(num_partitions) if (parallel)
+    {
+      for (int p : order[omp_get_thread_num()]) {
+        for (std::size_t idx = next[p]++; idx < range[p + 1]; idx = next[p]++) {
+          sweep(idx);
+        }
+      }
+    }
+  }
+
+  //! The shared mesh, and parts of it used at every local solve.
+  std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry;
+  const MeshAdjacency<PHDIM> &adjacency;
+  //! Lower bounds used to skip the local problems that cannot help.
+  const Eikonal::LocalProblemBounds<PHDIM> &bounds;
+  const Mat &mat;
+  //! Values and sources of this solve.
+  Eikonal::SolveState state;
+  //! Whether the values are copied to the nodes of the mesh (Node::u).
+  bool publishToNodes = false;
   std::vector<int> activeList;
-  Mat &mat;
+  //! Set for the nodes in activeList (queued nodes for updateAsync()).
+  Eikonal::NodeFlags activeFlags;
+  //! The deques of updateAsync(), and the links of their nodes by id: a
+  //! node is in one deque at most.
+  std::vector<WorkQueue> asyncQueues;
+  std::vector<std::vector<int>> asyncOrder;
+  std::vector<int> queuedPrev;
+  std::vector<int> queuedNext;
+  //! Nodes activated and converged during a sweep of update().
+  std::vector<int> toAdd;
+  std::vector<int> toRemove;
+  ParallelGranularity granularity;
+  std::size_t cutoff = 0;
+  Eikonal::LocalSolverType localSolver = Eikonal::defaultLocalSolver;
+  //! The engine set by name, null for the built-in local solvers.
+  std::shared_ptr<const Eikonal::LocalSolverEngine<PHDIM>> engine;
+  //! Options of the iterative local solvers.
+  Eikonal::LocalSolverOptions localOptions;
+  //! Last change of every node, empty without a tolerance schedule.
+  Eikonal::AdaptiveTolerance tolerances;
+  Eikonal::EarlyTermination<PHDIM> termination;
+  //! NUMA node of every pinned thread, empty unless in NUMA mode.
+  std::vector<int> threadNode;
+  //! stealOrder() and the per-partition ranges of sweepByPartition().
+  std::vector<std::vector<int>> partitionOrder;
+  std::vector<std::size_t> partitionRange;
+  std::vector<std::atomic<std::size_t>> partitionNext;
+  Eikonal::StatisticsCounters statistics;
+  //! Last lambda of every (node, element) pair, empty without warm start.
+  Eikonal::LambdaCache<PHDIM> lambdaCache;
+  //! Last solution of every (node, element) pair, empty unless enabled.
+  Eikonal::LocalSolutionCache<PHDIM> solutionCache;
+
+  /**
+   * @brief The ids of the nodes flagged isSource.
+   */
+  static std::vector<unsigned int>
+  sourcesOf(const std::vector<Mesh_element<PHDIM>> &mesh) {
+    std::vector<unsigned int> sources;
+    for (const auto &element : mesh) {
+      for (const auto &vertex : element.vertex) {
+        if (vertex->isSource) {
+          sources.push_back(vertex->id);
+        }
+      }
+    }
+    return sources;
+  }
 
-  bool isInActiveList(Node<PHDIM> &node) {
-    return std::find(activeList.begin(), activeList.end(), node.id) !=
-           activeList.end();
+  /**
+   * @brief End of an update: the nodes left out by the stopping criteria
+   * are marked unreached, and the values published.
+   */
+  void finish() {
+    if (termination.enabled()) {
+      termination.finish(state.u, state.isSource, INF);
+    }
+    publish();
   }
 
-  void initializeMaps() {
-#pragma omp parallel for schedule(dynamic) default(shared)
-    for (size_t i = 0; i < mesh.size(); ++i) {
-#pragma omp critical
-      for (auto &node : mesh[i].vertex) {
-        nodes[node->id] = node;
-        nodeToElements[node->id].push_back(mesh[i]);
+  /**
+   * @brief Copy the values to the nodes of the mesh, when built from them.
+   */
+  void publish() {
+    if (!publishToNodes) {
+      return;
+    }
+    const long num_ids = static_cast<long>(state.size());
+#pragma omp parallel for schedule(static) default(shared)
+    for (long id = 0; id < num_ids; ++id) {
+      if (const auto &node = adjacency.node(id)) {
+        node->u = state.u[id];
       }
     }
   }
 
+  /**
+   * @brief Size the active flags and the buffers of update(), which can
+   * hold every node at once.
+   */
+  void initializeMaps() {
+    statistics.resize(omp_get_max_threads());
+    activeFlags.resize(adjacency.size());
+    activeList.reserve(adjacency.size());
+    toAdd.resize(adjacency.size());
+    toRemove.resize(adjacency.size());
+    queuedPrev.resize(adjacency.size());
+    queuedNext.resize(adjacency.size());
+    prepareQueues();
+  }
+
+  /**
+   * @brief Set the initial values and the initial frontier.
+   *
+   * Every thread collects the neighbours of the sources it scans; the
+   * active flags make sure a node shared by several sources is taken once.
+   * The per-thread lists are then concatenated in thread order.
+   */
   void initialize() {
-#pragma omp parallel for schedule(dynamic) default(shared)
-    for (auto &m_element : mesh) {
-      for (auto &node : m_element.vertex) {
-        if (node->isSource) {
-          node->u = 0.0;
-#pragma omp critical
-          for (auto &neighbour : getNeighbours(*node)) {
-            if (!isInActiveList(*neighbour) && !neighbour->isSource) {
-              activeList.push_back(neighbour->id);
-            }
+    const long num_ids = static_cast<long>(adjacency.size());
+    activeList.clear();
+
+#pragma omp parallel for schedule(static) default(shared)
+    for (long id = 0; id < num_ids; ++id) {
+      if (!state.isSource[id]) {
+        state.u[id] = INF;
+      }
+    }
+
+    std::vector<std::size_t> offset(omp_get_max_threads() + 1, 0);
+#pragma omp parallel default(shared)
+    {
+      const int tid = omp_get_thread_num();
+      std::vector<int> frontier;
+#pragma omp for schedule(static)
+      for (long id = 0; id < num_ids; ++id) {
+        if (!state.isSource[id]) {
+          continue;
+        }
+        for (auto neighbour_id : adjacency.neighboursOf(id)) {
+          if (!state.isSource[neighbour_id] &&
+              activeFlags.testAndSet(neighbour_id)) {
+            frontier.push_back(neighbour_id);
           }
-        } else {
-          node->u = INF;
         }
       }
+      offset[tid + 1] = frontier.size();
+#pragma omp barrier
+#pragma omp single
+      {
+        for (std::size_t t = 1; t < offset.size(); ++t) {
+          offset[t] += offset[t - 1];
+        }
+        activeList.resize(offset.back());
+      }
+      std::copy(frontier.begin(), frontier.end(),
+                activeList.begin() + offset[tid]);
     }
   }
 
-  double solveLocal(Node<PHDIM> &node) {
-    using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
-    using VectorExt = typename Eikonal::Eikonal_traits<PHDIM>::VectorExt;
+  /**
+   * @brief Whether solveLocal() should spread the elements over threads.
+   *
+   * Never inside a parallel region: the caller is already one of the
+   * threads working across the frontier.
+   */
+  bool parallelOverElements() const {
+    return granularity != ParallelGranularity::Nodes && !omp_in_parallel();
+  }
 
-    double min_value = INF;
-    auto &elements = nodeToElements[node.id];
+  /**
+   * @brief Whether a sweep of update() should spread the frontier over
+   * threads.
+   */
+  bool parallelOverNodes(std::size_t frontier_size) const {
+    switch (granularity) {
+    case ParallelGranularity::Nodes:
+      return true;
+    case ParallelGranularity::Elements:
+      return false;
+    default:
+      return frontier_size >= hybridCutoff();
+    }
+  }
 
-#pragma omp parallel default(shared) reduction(min : min_value)
-    {
-      std::vector<NodePtr<PHDIM>> nodes_for_points;
+  std::size_t hybridCutoff() const {
+    return cutoff > 0 ? cutoff
+                      : static_cast<std::size_t>(omp_get_max_threads());
+  }
 
-#pragma omp for schedule(dynamic) nowait
-      for (size_t idx = 0; idx < elements.size(); ++idx) {
-        auto &mesh_element = elements[idx];
+  /**
+   * @brief The smallest local solution around a node, or its current value
+   * if none is lower.
+   *
+   * Elements whose lower bound is not below the current value are skipped.
+   * The iterative local solvers use the options of setLocalSolverOptions(),
+   * with the tolerance of the schedule for this node if any.
+   *
+   * @param approximate Whether a local solve was loose and iterated (see
+   * solveSimplex()): then the result cannot declare the node converged.
+   */
+  double solveLocal(unsigned int id, bool &approximate) {
+    const auto options = tolerances.options(id, localOptions);
+    bool any_approximate = false;
+    const double current = Eikonal::atomicLoad(state.u[id]);
+    double min_value = current;
+    const auto elements = adjacency.elementsOf(id);
 
-        for (auto &mesh_node : mesh_element.vertex) {
-          if (mesh_node->id != node.id) {
-            nodes_for_points.push_back(mesh_node);
+    if (localSolver == Eikonal::LocalSolverType::Batched) {
+      // The batch is the unit of parallelism: no threads over elements
+      Eikonal::simd::LocalProblemBatch<PHDIM> batch;
+      std::array<Point, PHDIM + 1> simplex_points;
+      VectorExt values;
+      for (auto e : elements) {
+        if (!skipElement(id, e, current) &&
+            gatherSimplex(id, e, simplex_points, values)) {
+          if (geometry->isUniform()) {
+            batch.add(simplex_points, values);
+          } else {
+            batch.add(simplex_points, values, geometry->tensorOf(e));
           }
+          ++statistics.local().localSolves;
         }
-
-        if (nodes_for_points.size() < PHDIM) {
-          nodes_for_points.clear();
-          continue;
+        if (batch.full()) {
+          Eikonal::simd::solveBatch(batch, mat);
+          min_value = batch.minResult(min_value);
+          batch.clear();
         }
+      }
+      Eikonal::simd::solveBatch(batch, mat);
+      approximate = false;
+      return batch.minResult(min_value);
+    }
 
-        std::array<Point, PHDIM + 1> simplex_points;
-        for (unsigned int i = 0; i < PHDIM; ++i) {
-          simplex_points[i] = nodes_for_points[i]->p;
+    if (parallelOverElements()) {
+#pragma omp parallel for schedule(static) default(shared)                    \
+    reduction(min : min_value) reduction(|| : any_approximate)
+      for (size_t idx = 0; idx < elements.size(); ++idx) {
+        if (!skipElement(id, elements.first[idx], current)) {
+          min_value = std::min(
+              min_value, solveElement(id, idx, options, any_approximate));
         }
-        simplex_points[PHDIM] = node.p;
-
-        VectorExt values;
-        for (unsigned int i = 0; i < PHDIM; ++i) {
-          values[i] = nodes_for_points[i]->u;
+      }
+    } else {
+      for (size_t idx = 0; idx < elements.size(); ++idx) {
+        if (!skipElement(id, elements.first[idx], current)) {
+          min_value = std::min(
+              min_value, solveElement(id, idx, options, any_approximate));
         }
-
-        Eikonal::SimplexData<PHDIM> simplex{simplex_points, mat};
-        Eikonal::solveEikonalLocalProblem<PHDIM> solver{simplex, values};
-        auto sol = solver();
-        min_value = std::min(min_value, sol.value);
-        nodes_for_points.clear();
       }
     }
+    approximate = any_approximate;
     return min_value;
   }
+
+  /**
+   * @brief Whether the local problem of element e cannot lower the value of
+   * the node below current (see Eikonal::LocalProblemBounds); counts the
+   * outcome in the statistics of the calling thread.
+   */
+  bool skipElement(unsigned int id, std::size_t e, double current) {
+    auto &stats = statistics.local();
+    double base_min;
+    const double bound =
+        bounds.lowerBound(e, geometry->element(e), id, state.u, base_min);
+    if (base_min >= INF) {
+      ++stats.skippedInfinite;
+      return true;
+    }
+    if (bound >= current) {
+      ++stats.skippedBound;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief The local problem of element e around a node: the other
+   * vertices with their values, then the node.
+   *
+   * @return false if the element is degenerate.
+   */
+  bool gatherSimplex(unsigned int id, std::size_t e,
+                     std::array<Point, PHDIM + 1> &simplex_points,
+                     VectorExt &values) const {
+    unsigned int count = 0;
+    for (auto vertex : geometry->element(e)) {
+      if (vertex != id && count < PHDIM) {
+        simplex_points[count] = geometry->point(vertex);
+        values[count] = Eikonal::atomicLoad(state.u[vertex]);
+        ++count;
+      }
+    }
+    simplex_points[PHDIM] = geometry->point(id);
+    return count == PHDIM;
+  }
+
+  /**
+   * @brief Solve the local problem of one element around a node, or take
+   * its solution from the cache if the values at the base did not change.
+   *
+   * Approximate solutions (see solveSimplex()) are not cached.
+   *
+   * @param idx Position of the element in the row of the node.
+   * @param approximate Set to true if the solution is approximate.
+   * @return The candidate value, INF if the element is degenerate.
+   */
+  double solveElement(unsigned int id, std::size_t idx,
+                      const Eikonal::LocalSolverOptions &options,
+                      bool &approximate) {
+    std::array<Point, PHDIM + 1> simplex_points;
+    VectorExt values;
+    const std::size_t e = adjacency.elementsOf(id).first[idx];
+    if (!gatherSimplex(id, e, simplex_points, values)) {
+      return INF;
+    }
+    auto &stats = statistics.local();
+    const std::size_t slot = adjacency.elementSlot(id, idx);
+    if (!solutionCache.empty()) {
+      double cached;
+      if (solutionCache.lookup(slot, values, cached)) {
+        ++stats.cacheHits;
+        return cached;
+      }
+      ++stats.cacheMisses;
+    }
+    bool loose_solution = false;
+    const double value =
+        solveSimplex(slot, e, simplex_points, values, options, loose_solution);
+    if (!solutionCache.empty() && !loose_solution) {
+      solutionCache.store(slot, values, value);
+    }
+    approximate = approximate || loose_solution;
+    return value;
+  }
+
+  /**
+   * @brief Run the local solver on a simplex.
+   *
+   * With the warm start the iterative solvers start from the lambda of the
+   * previous solve of the same (node, element) pair, and store the new one.
+   *
+   * @param slot The (node, element) pair, see MeshAdjacency::elementSlot().
+   * @param e The element.
+   * @param approximate Set to true if the tolerance was looser than the
+   * final one and the solver iterated; a solution found without iterations
+   * (a vertex or an edge of the base satisfying the optimality conditions)
+   * is exact whatever the tolerance.
+   */
+  double solveSimplex(std::size_t slot, std::size_t e,
+                      const std::array<Point, PHDIM + 1> &simplex_points,
+                      const VectorExt &values,
+                      const Eikonal::LocalSolverOptions &options,
+                      bool &approximate) {
+    auto &stats = statistics.local();
+    ++stats.localSolves;
+    const bool loose =
+        Eikonal::isIterative(localSolver) && !tolerances.isFinal(options);
+    if (loose) {
+      ++stats.looseSolves;
+    }
+    Eikonal::SimplexData<PHDIM> simplex{simplex_points,
+                                        geometry->anisotropyOf(e)};
+    const bool warm =
+        !lambdaCache.empty() && Eikonal::isIterative(localSolver);
+    Lambda lambda;
+    if (warm && lambdaCache.load(slot, lambda)) {
+      ++stats.warmStarts;
+    } else {
+      lambda.fill(0.333);
+    }
+    const auto solution =
+        engine ? engine->solve(simplex, values, lambda, options)
+               : Eikonal::solveLocalProblem(localSolver, simplex, values,
+                                            lambda, options);
+    stats.newtonIterations += solution.iterations;
+    approximate = loose && solution.iterations > 0;
+    if (warm) {
+      lambdaCache.store(slot, solution.lambda);
+    }
+    return solution.value;
+  }
 };
 
 #endif // PARALLELEIKONALSOLVER_HPP
\ No newline at end of file
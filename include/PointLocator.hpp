@@ -0,0 +1,184 @@
+#ifndef POINTLOCATOR_HPP
+#define POINTLOCATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Eikonal_traits.hpp"
+#include "MeshGeometry.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief Finds the element that contains a point, through a uniform grid
+ * over the bounding box of the mesh.
+ *
+ * Every cell of the grid lists, in CSR form, the elements whose bounding box
+ * overlaps it; there are about as many cells as elements. A query tests the
+ * elements of one cell only, with their barycentric coordinates.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class PointLocator {
+public:
+  using Point = typename Eikonal_traits<PHDIM>::Point;
+  //! Barycentric coordinates, one per vertex of an element.
+  using Barycentric = std::array<double, PHDIM + 1>;
+
+  //! What locate() returns for a point outside the mesh.
+  static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  explicit PointLocator(const MeshGeometry<PHDIM> &geometry)
+      : geometry(geometry) {
+    const std::size_t num_elements = geometry.numElements();
+    if (num_elements == 0) {
+      return;
+    }
+    lower = upper = geometry.point(geometry.element(0)[0]);
+    for (std::size_t e = 0; e < num_elements; ++e) {
+      for (auto id : geometry.element(e)) {
+        lower = lower.cwiseMin(geometry.point(id));
+        upper = upper.cwiseMax(geometry.point(id));
+      }
+    }
+    const auto per_axis = static_cast<std::size_t>(std::max(
+        1.0, std::ceil(std::pow(static_cast<double>(num_elements),
+                                1.0 / PHDIM))));
+    std::size_t num_cells = 1;
+    for (unsigned int i = 0; i < PHDIM; ++i) {
+      cells[i] = per_axis;
+      num_cells *= per_axis;
+      const double extent = upper[i] - lower[i];
+      cellSize[i] = extent > 0.0 ? extent / per_axis : 1.0;
+    }
+
+    // Counting sort of the (cell, element) pairs, as in MeshAdjacency
+    offsets.assign(num_cells + 1, 0);
+    forEachCell([&](std::size_t cell, std::size_t) { ++offsets[cell + 1]; });
+    for (std::size_t c = 0; c < num_cells; ++c) {
+      offsets[c + 1] += offsets[c];
+    }
+    elements.resize(offsets.back());
+    std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+    forEachCell([&](std::size_t cell, std::size_t e) {
+      elements[cursor[cell]++] = static_cast<unsigned int>(e);
+    });
+  }
+
+  /**
+   * @brief The element that contains a point, none if there is none. A
+   * point on a face shared by several elements gives one of them.
+   *
+   * @param coordinates The barycentric coordinates of the point in the
+   * element, if not null.
+   */
+  std::size_t locate(const Point &p, Barycentric *coordinates = nullptr) const {
+    if (elements.empty()) {
+      return none;
+    }
+    const double slack = tolerance * (upper - lower).norm();
+    if (((p - lower).array() < -slack).any() ||
+        ((p - upper).array() > slack).any()) {
+      return none;
+    }
+    std::size_t cell = 0;
+    for (unsigned int i = PHDIM; i-- > 0;) {
+      cell = cell * cells[i] + index(i, p[i]);
+    }
+    for (std::size_t k = offsets[cell]; k < offsets[cell + 1]; ++k) {
+      Barycentric lambda = barycentric(elements[k], p);
+      if (*std::min_element(lambda.begin(), lambda.end()) >= -tolerance) {
+        if (coordinates) {
+          *coordinates = lambda;
+        }
+        return elements[k];
+      }
+    }
+    return none;
+  }
+
+  /**
+   * @brief The barycentric coordinates of a point in an element.
+   */
+  Barycentric barycentric(std::size_t e, const Point &p) const {
+    const auto &vertices = geometry.element(e);
+    const Point &origin = geometry.point(vertices[PHDIM]);
+    Eigen::Matrix<double, PHDIM, PHDIM> edges;
+    for (unsigned int v = 0; v < PHDIM; ++v) {
+      edges.col(v) = geometry.point(vertices[v]) - origin;
+    }
+    const Eigen::Matrix<double, PHDIM, 1> solution =
+        edges.fullPivLu().solve(p - origin);
+    Barycentric lambda;
+    lambda[PHDIM] = 1.0;
+    for (unsigned int v = 0; v < PHDIM; ++v) {
+      lambda[v] = std::isfinite(solution[v]) ? solution[v] : -1.0;
+      lambda[PHDIM] -= lambda[v];
+    }
+    return lambda;
+  }
+
+private:
+  //! Relative slack of the containment tests, for points on a face.
+  static constexpr double tolerance = 1e-10;
+
+  //! The cell of a coordinate along an axis, clamped to the grid.
+  std::size_t index(unsigned int axis, double x) const {
+    const double position = std::floor((x - lower[axis]) / cellSize[axis]);
+    return static_cast<std::size_t>(std::clamp(
+        position, 0.0, static_cast<double>(cells[axis] - 1)));
+  }
+
+  //! Call f(cell, e) for every cell that the bounding box of e overlaps.
+  template <typename F> void forEachCell(F &&f) const {
+    for (std::size_t e = 0; e < geometry.numElements(); ++e) {
+      Point box_lower = geometry.point(geometry.element(e)[0]);
+      Point box_upper = box_lower;
+      for (auto id : geometry.element(e)) {
+        box_lower = box_lower.cwiseMin(geometry.point(id));
+        box_upper = box_upper.cwiseMax(geometry.point(id));
+      }
+      std::array<std::size_t, PHDIM> first, last, at;
+      for (unsigned int i = 0; i < PHDIM; ++i) {
+        first[i] = at[i] = index(i, box_lower[i]);
+        last[i] = index(i, box_upper[i]);
+      }
+      // Odometer over the cells of the box
+      while (true) {
+        std::size_t cell = 0;
+        for (unsigned int i = PHDIM; i-- > 0;) {
+          cell = cell * cells[i] + at[i];
+        }
+        f(cell, e);
+        unsigned int i = 0;
+        while (i < PHDIM && at[i] == last[i]) {
+          at[i] = first[i];
+          ++i;
+        }
+        if (i == PHDIM) {
+          break;
+        }
+        ++at[i];
+      }
+    }
+  }
+
+  const MeshGeometry<PHDIM> &geometry;
+  Point lower = Point::Zero();
+  Point upper = Point::Zero();
+  std::array<std::size_t, PHDIM> cells{};
+  Point cellSize = Point::Ones();
+  //! CSR: the elements of cell c are elements[offsets[c]..offsets[c+1]).
+  std::vector<std::size_t> offsets;
+  std::vector<unsigned int> elements;
+};
+
+} // namespace Eikonal
+
+#endif // POINTLOCATOR_HPP
@@ -0,0 +1,293 @@
+#ifndef POINTTOPOINTSOLVER_HPP
+#define POINTTOPOINTSOLVER_HPP
+
+#include "BatchedLocalSolver.hpp"
+#include "EikonalSolver.hpp"
+#include "MeshGeometry.hpp"
+#include "SolverStatistics.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Eikonal {
+
+/**
+ * @brief The answer to a point-to-point query.
+ */
+struct QueryResult {
+  //! Travel time from the source to the target, INF if it is not reached.
+  double time = INF;
+  //! The nodes the front expanded, in the order they were first expanded.
+  std::vector<unsigned int> visited;
+};
+
+} // namespace Eikonal
+
+/**
+ * @brief Travel time between two nodes, without solving the whole field.
+ *
+ * The query is the propagation of ParallelEikonalSolver with the active list
+ * replaced by a priority queue, as in the fast marching method: the node
+ * with the smallest key is expanded, i.e. the local problems of its
+ * neighbours are solved, and a neighbour lowered by EPSILON or more is
+ * queued (again). A node may be expanded more than once, so the values are
+ * those the iterative solvers converge to, on any mesh. The local solver is
+ * the batched closed form, with the lower bounds of the geometry.
+ *
+ * The front is ordered by value plus the metric distance to the target, as
+ * in A*, and stops as soon as no queued node can lower the result: a key is a
+ * lower bound of the values the node leads to, since a value grows at least
+ * by the metric distance, sqrt(d^T M d), it covers; with an anisotropy field
+ * by the euclidean distance times MeshGeometry::slownessBound(), a weaker
+ * heuristic that expands more nodes. The keys are compared
+ * with the result plus the longest edge, as a value may come from neighbours
+ * slightly later than itself when the elements are not acute.
+ *
+ * There is no front from the target: the discrete values do not add up
+ * along a path, so the values of a backward front give neither the time
+ * where the fronts meet nor a bound the forward front could use, and it
+ * would only add expansions.
+ *
+ * The buffers are sized at construction and only the nodes a query touched
+ * are reset after it, so the cost of a query follows the region its front
+ * covers, not the mesh.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> class PointToPointSolver {
+  using Point = typename Eikonal::Eikonal_traits<PHDIM>::Point;
+  using Mat = typename Eikonal::Eikonal_traits<PHDIM>::MMatrix;
+
+public:
+  /**
+   * @param geometry The mesh, which may be shared with other solvers.
+   */
+  explicit PointToPointSolver(
+      std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry)
+      : geometry(std::move(geometry)),
+        adjacency(this->geometry->getAdjacency()),
+        bounds(this->geometry->getBounds()),
+        mat(this->geometry->getAnisotropy()),
+        slowness(this->geometry->slownessBound()),
+        margin(this->geometry->longestEdge()) {
+    front.u.assign(this->geometry->numNodes(), INF);
+    expanded.assign(this->geometry->numNodes(), 0);
+  }
+
+  /**
+   * @brief Travel time from source to target, and the nodes visited.
+   *
+   * @throw std::invalid_argument If the source or the target is not a node
+   * of the mesh.
+   */
+  Eikonal::QueryResult query(unsigned int source, unsigned int target) {
+    for (auto id : {source, target}) {
+      if (id >= geometry->numNodes() || !geometry->hasNode(id)) {
+        throw std::invalid_argument("Node " + std::to_string(id) +
+                                    " is not in the mesh");
+      }
+    }
+    Eikonal::QueryResult result;
+    if (source == target) {
+      result.time = 0.0;
+      return result;
+    }
+    start(source, target);
+    result.time = settle(result.visited);
+    reset(result.visited);
+    return result;
+  }
+
+  /**
+   * @brief Counters of the queries since construction or the last reset.
+   */
+  const Eikonal::SolverStatistics &getStatistics() const {
+    return statistics;
+  }
+
+  void resetStatistics() { statistics = Eikonal::SolverStatistics{}; }
+
+  const std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> &
+  getGeometry() const {
+    return geometry;
+  }
+
+private:
+  //! A queued node: key, then id, smallest key on top.
+  using Entry = std::pair<double, unsigned int>;
+
+  //! The values of the propagation from the source, and its queue.
+  struct Front {
+    std::vector<double> u;
+    std::vector<Entry> heap;
+    //! The nodes with a value, to reset after the query.
+    std::vector<unsigned int> touched;
+    //! Origin of the front and node it is directed to.
+    unsigned int origin = 0;
+    unsigned int goal = 0;
+
+    //! Smallest key queued, INF if the queue is empty.
+    double top() const { return heap.empty() ? INF : heap.front().first; }
+  };
+
+  /**
+   * @brief Expand the front until no queued node can lower the value of its
+   * goal, and return that value.
+   */
+  double settle(std::vector<unsigned int> &visited) {
+    while (!front.heap.empty() &&
+           front.top() <= front.u[front.goal] + margin) {
+      expand(visited);
+    }
+    return front.u[front.goal];
+  }
+
+  void start(unsigned int origin, unsigned int goal) {
+    front.heap.clear();
+    front.origin = origin;
+    front.goal = goal;
+    front.u[origin] = 0.0;
+    front.touched.push_back(origin);
+    push(origin);
+  }
+
+  //! Metric distance to the goal, or a lower bound of it with an
+  //! anisotropy field: the A* heuristic.
+  double heuristic(unsigned int id) const {
+    const Point d = geometry->point(front.goal) - geometry->point(id);
+    return geometry->isUniform() ? std::sqrt(d.dot(mat * d))
+                                 : slowness * d.norm();
+  }
+
+  void push(unsigned int id) {
+    front.heap.emplace_back(front.u[id] + heuristic(id), id);
+    std::push_heap(front.heap.begin(), front.heap.end(),
+                   std::greater<Entry>());
+  }
+
+  /**
+   * @brief Expand the node with the smallest key, skipping the entries of
+   * the nodes lowered since they were queued.
+   */
+  void expand(std::vector<unsigned int> &visited) {
+    std::pop_heap(front.heap.begin(), front.heap.end(),
+                  std::greater<Entry>());
+    const auto [key, id] = front.heap.back();
+    front.heap.pop_back();
+    if (key > front.u[id] + heuristic(id)) {
+      return;
+    }
+    if (!expanded[id]) {
+      expanded[id] = 1;
+      visited.push_back(id);
+    }
+    for (auto neighbour : adjacency.neighboursOf(id)) {
+      if (neighbour == front.origin) {
+        continue;
+      }
+      const double previous = front.u[neighbour];
+      const double value = solveNode(neighbour);
+      if (previous - value < EPSILON) {
+        continue;
+      }
+      if (previous >= INF) {
+        front.touched.push_back(neighbour);
+      }
+      front.u[neighbour] = value;
+      push(neighbour);
+    }
+  }
+
+  /**
+   * @brief Smallest local solution of a node in the front, or its value if
+   * none is lower. An element is skipped when its base is unreached or its
+   * lower bound (see Eikonal::LocalProblemBounds) is not below the value.
+   */
+  double solveNode(unsigned int id) {
+    double best = front.u[id];
+    batch.clear();
+    for (auto e : adjacency.elementsOf(id)) {
+      // The base vertices in element order, as in the other solvers
+      std::array<Point, PHDIM + 1> points;
+      std::array<double, PHDIM> values;
+      double base_min = INF;
+      double node_distance = 0.0;
+      unsigned int count = 0;
+      const auto &vertices = geometry->element(e);
+      for (unsigned int v = 0; v <= PHDIM; ++v) {
+        if (vertices[v] == id) {
+          node_distance = bounds.distanceOf(e, v);
+        } else if (count < PHDIM) {
+          points[count] = geometry->point(vertices[v]);
+          values[count] = front.u[vertices[v]];
+          base_min = std::min(base_min, values[count]);
+          ++count;
+        }
+      }
+      if (count < PHDIM) {
+        continue;
+      }
+      if (base_min >= INF) {
+        ++statistics.skippedInfinite;
+        continue;
+      }
+      if (base_min + node_distance >= best) {
+        ++statistics.skippedBound;
+        continue;
+      }
+      points[PHDIM] = geometry->point(id);
+      ++statistics.localSolves;
+      if (geometry->isUniform()) {
+        batch.add(points, values);
+      } else {
+        batch.add(points, values, geometry->tensorOf(e));
+      }
+      if (batch.full()) {
+        Eikonal::simd::solveBatch(batch, mat);
+        best = batch.minResult(best);
+        batch.clear();
+      }
+    }
+    if (batch.size > 0) {
+      Eikonal::simd::solveBatch(batch, mat);
+      best = batch.minResult(best);
+    }
+    return best;
+  }
+
+  //! Back to unreached, for the next query.
+  void reset(const std::vector<unsigned int> &visited) {
+    for (auto id : front.touched) {
+      front.u[id] = INF;
+    }
+    front.touched.clear();
+    front.heap.clear();
+    for (auto id : visited) {
+      expanded[id] = 0;
+    }
+  }
+
+  std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry;
+  const MeshAdjacency<PHDIM> &adjacency;
+  const Eikonal::LocalProblemBounds<PHDIM> &bounds;
+  const Mat &mat;
+  //! Lower bound of the travel time per unit length, see heuristic().
+  double slowness;
+  //! Longest edge: the slack of the stopping tests.
+  double margin;
+  //! From the source of the current query.
+  Front front;
+  //! Whether a node is in the visited list of the current query.
+  std::vector<char> expanded;
+  Eikonal::simd::LocalProblemBatch<PHDIM> batch;
+  Eikonal::SolverStatistics statistics;
+};
+
+#endif // POINTTOPOINTSOLVER_HPP
@@ -0,0 +1,117 @@
+#ifndef SOLVESTATE_HPP
+#define SOLVESTATE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "NumaUtils.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief A node whose value is prescribed, g(x) = time: a source that may
+ * start later than the others (see BoundaryConditions.hpp). The value is a
+ * boundary condition: a front that reaches the node earlier does not lower
+ * it. The label tells the sources apart in the output (see sourceLabels()),
+ * -1 for none.
+ */
+struct BoundaryValue {
+  unsigned int node;
+  double time;
+  int label = -1;
+};
+
+//! The values of a solve, by node id (see SolveState::u).
+using NodeValues = numa::PartitionedVector<double>;
+
+/**
+ * @brief What changes from one solve to another on the same mesh: the
+ * values, the sources and their labels, by node id.
+ *
+ * Every solver owns one, while the mesh itself is shared (see
+ * MeshGeometry). The values are plain doubles, updated by the parallel
+ * engines with the atomic helpers of AtomicUtils.hpp. The arrays are first
+ * touched by the threads owning the ids (see Eikonal::numa::firstTouch()).
+ */
+struct SolveState {
+  //! The value of every node; the value of a source is its boundary value.
+  NodeValues u;
+  //! Whether every node is a source; char, so that the flags are bytes.
+  numa::PartitionedVector<char> isSource;
+  //! The label of every source, -1 for the other nodes.
+  numa::PartitionedVector<int> label;
+
+  /**
+   * @brief Room for num_nodes node ids, no sources, every value set to
+   * initial.
+   */
+  void resize(std::size_t num_nodes, double initial) {
+    numa::firstTouch(u, num_nodes, [initial](std::size_t) { return initial; });
+    numa::firstTouch(isSource, num_nodes, [](std::size_t) { return char{0}; });
+    numa::firstTouch(label, num_nodes, [](std::size_t) { return -1; });
+  }
+
+  std::size_t size() const { return u.size(); }
+
+  /**
+   * @brief Mark the given node ids as sources, with value 0, labelled with
+   * their id.
+   *
+   * @throw std::invalid_argument If an id is out of range.
+   */
+  void setSources(const std::vector<unsigned int> &sources) {
+    for (auto id : sources) {
+      checkSource(id);
+      addSource(id);
+    }
+  }
+
+  /**
+   * @brief Make a node a source, with value 0, labelled with its id.
+   */
+  void addSource(unsigned int id) {
+    isSource[id] = 1;
+    u[id] = 0.0;
+    label[id] = static_cast<int>(id);
+  }
+
+  /**
+   * @brief Mark the nodes of the boundary values as sources, with their
+   * time and label; a node given twice keeps the smallest time.
+   *
+   * @throw std::invalid_argument If an id is out of range or a time is not
+   * finite.
+   */
+  void setBoundaryValues(const std::vector<BoundaryValue> &values) {
+    for (const auto &value : values) {
+      checkSource(value.node);
+      if (!std::isfinite(value.time)) {
+        throw std::invalid_argument("The time of source node " +
+                                    std::to_string(value.node) +
+                                    " is not finite");
+      }
+    }
+    for (const auto &value : values) {
+      if (!isSource[value.node] || value.time < u[value.node]) {
+        u[value.node] = value.time;
+        label[value.node] = value.label;
+      }
+      isSource[value.node] = 1;
+    }
+  }
+
+private:
+  void checkSource(unsigned int id) const {
+    if (id >= isSource.size()) {
+      throw std::invalid_argument("Source node " + std::to_string(id) +
+                                  " is not in the mesh");
+    }
+  }
+};
+
+} // namespace Eikonal
+
+#endif // SOLVESTATE_HPP
@@ -0,0 +1,120 @@
+#ifndef SOLVERSTATISTICS_HPP
+#define SOLVERSTATISTICS_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include <omp.h>
+
+namespace Eikonal {
+
+/**
+ * @brief Counters of the local problems met by a solver.
+ */
+struct SolverStatistics {
+  //! Local problems actually solved (not skipped nor found in the cache).
+  std::size_t localSolves = 0;
+  //! Skipped: every value at the base of the simplex is still INF.
+  std::size_t skippedInfinite = 0;
+  //! Skipped: the lower bound is not below the current value of the node.
+  std::size_t skippedBound = 0;
+  //! Iterations of the iterative local solvers, over all their solves.
+  std::size_t newtonIterations = 0;
+  //! Newton solves started from a cached lambda (see LambdaCache).
+  std::size_t warmStarts = 0;
+  //! Local problems answered by the cache (see LocalSolutionCache).
+  std::size_t cacheHits = 0;
+  //! Local problems looked up in the cache and solved.
+  std::size_t cacheMisses = 0;
+  //! Local solves with a tolerance looser than the final one (see
+  //! ToleranceSchedule).
+  std::size_t looseSolves = 0;
+
+  std::size_t skipped() const { return skippedInfinite + skippedBound; }
+
+  /**
+   * @brief Fraction of the cache lookups that found the solution.
+   */
+  double cacheHitRate() const {
+    const std::size_t lookups = cacheHits + cacheMisses;
+    return lookups > 0 ? static_cast<double>(cacheHits) / lookups : 0.0;
+  }
+
+  SolverStatistics &operator+=(const SolverStatistics &other) {
+    localSolves += other.localSolves;
+    skippedInfinite += other.skippedInfinite;
+    skippedBound += other.skippedBound;
+    newtonIterations += other.newtonIterations;
+    warmStarts += other.warmStarts;
+    cacheHits += other.cacheHits;
+    cacheMisses += other.cacheMisses;
+    looseSolves += other.looseSolves;
+    return *this;
+  }
+};
+
+inline std::ostream &operator<<(std::ostream &out,
+                                const SolverStatistics &stats) {
+  return out << "local solves: " << stats.localSolves
+             << ", skipped (INF base): " << stats.skippedInfinite
+             << ", skipped (lower bound): " << stats.skippedBound
+             << ", Newton iterations: " << stats.newtonIterations
+             << ", warm starts: " << stats.warmStarts
+             << ", cache hit rate: " << stats.cacheHitRate()
+             << ", loose solves: " << stats.looseSolves;
+}
+
+/**
+ * @brief One SolverStatistics per OpenMP thread.
+ *
+ * Every thread increments its own counters, padded to a cache line, so the
+ * counting needs neither atomics nor shared cache lines. total() sums them.
+ */
+class StatisticsCounters {
+public:
+  /**
+   * @brief One slot per thread of the OpenMP pool, all zero.
+   */
+  void resize(std::size_t num_threads) { slots.assign(num_threads, Slot{}); }
+
+  /**
+   * @brief At least one slot per thread of a pool of num_threads, keeping
+   * the counters: the pool may have grown since resize(). Allocates only
+   * when it grows.
+   */
+  void grow(std::size_t num_threads) {
+    if (slots.size() < num_threads) {
+      slots.resize(num_threads);
+    }
+  }
+
+  /**
+   * @brief The counters of the calling thread.
+   */
+  SolverStatistics &local() { return slots[omp_get_thread_num()].stats; }
+
+  SolverStatistics total() const {
+    SolverStatistics sum;
+    for (const auto &slot : slots) {
+      sum += slot.stats;
+    }
+    return sum;
+  }
+
+  void reset() {
+    for (auto &slot : slots) {
+      slot.stats = SolverStatistics{};
+    }
+  }
+
+private:
+  struct alignas(64) Slot {
+    SolverStatistics stats;
+  };
+  std::vector<Slot> slots;
+};
+
+} // namespace Eikonal
+
+#endif // SOLVERSTATISTICS_HPP
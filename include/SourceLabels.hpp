@@ -0,0 +1,117 @@
+#ifndef SOURCELABELS_HPP
+#define SOURCELABELS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Eikonal_traits.hpp"
+#include "MeshGeometry.hpp"
+#include "SolveState.hpp"
+#include "solveEikonalLocalProblemAnalytic.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief The label of the source every node is reached from first, e.g. to
+ * draw the geodesic Voronoi regions of the sources, from one converged
+ * solve.
+ *
+ * The nodes are visited by increasing value. The label of a node is the one
+ * of the element its value comes from, the element with the smallest local
+ * solution: the label of the base vertex with the largest barycentric weight
+ * at the minimum, i.e. the vertex the characteristic comes in closest to.
+ * Only the vertices already labelled count; if there is none, the label is
+ * the one of the labelled neighbour with the smallest value. A pass of local
+ * solves after the solve, rather than a label carried by every update, so
+ * that the solvers and their engines are untouched and the labels are free
+ * unless asked for.
+ *
+ * @param state A converged solve, with the labels of its sources.
+ * @param unreached The value of the nodes not reached (INF): their label is
+ * -1.
+ */
+template <unsigned int PHDIM>
+std::vector<int> sourceLabels(const MeshGeometry<PHDIM> &geometry,
+                              const SolveState &state, double unreached) {
+  using Point = typename Eikonal_traits<PHDIM>::Point;
+  using VectorExt = typename Eikonal_traits<PHDIM>::VectorExt;
+
+  std::vector<int> labels(state.size(), -1);
+  std::vector<char> done(state.size(), 0);
+  std::vector<unsigned int> order;
+  for (std::size_t id = 0; id < state.size(); ++id) {
+    if (state.isSource[id]) {
+      labels[id] = state.label[id];
+      done[id] = 1;
+    } else if (state.u[id] < unreached && geometry.hasNode(id)) {
+      order.push_back(static_cast<unsigned int>(id));
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+    return state.u[a] < state.u[b];
+  });
+
+  const auto &adjacency = geometry.getAdjacency();
+  for (auto id : order) {
+    double best = unreached;
+    for (auto e : adjacency.elementsOf(id)) {
+      std::array<Point, PHDIM + 1> points;
+      std::array<unsigned int, PHDIM> base;
+      VectorExt values;
+      unsigned int count = 0;
+      for (auto vertex : geometry.element(e)) {
+        if (vertex != id && count < PHDIM) {
+          points[count] = geometry.point(vertex);
+          values[count] = state.u[vertex];
+          base[count++] = vertex;
+        }
+      }
+      if (count < PHDIM) {
+        continue;
+      }
+      points[PHDIM] = geometry.point(id);
+      const auto solution = solveEikonalLocalProblemAnalytic<PHDIM>{
+          SimplexData<PHDIM>{points, geometry.anisotropyOf(e)}, values}();
+      if (!(solution.value < best)) {
+        continue;
+      }
+      // The weight of base vertex PHDIM - 1 is what the others leave
+      double weight = -1.0;
+      int label = -1;
+      bool found = false;
+      double rest = 1.0;
+      for (unsigned int v = 0; v < PHDIM; ++v) {
+        const double w = v + 1 < PHDIM ? solution.lambda[v] : rest;
+        rest -= w;
+        if (done[base[v]] && w > weight) {
+          weight = w;
+          label = labels[base[v]];
+          found = true;
+        }
+      }
+      if (found) {
+        best = solution.value;
+        labels[id] = label;
+        done[id] = 1;
+      }
+    }
+    if (done[id]) {
+      continue;
+    }
+    double nearest = unreached;
+    for (auto neighbour : adjacency.neighboursOf(id)) {
+      if (done[neighbour] && state.u[neighbour] < nearest) {
+        nearest = state.u[neighbour];
+        labels[id] = labels[neighbour];
+      }
+    }
+    done[id] = 1;
+  }
+  return labels;
+}
+
+} // namespace Eikonal
+
+#endif // SOURCELABELS_HPP
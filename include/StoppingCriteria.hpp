@@ -0,0 +1,153 @@
+#ifndef STOPPINGCRITERIA_HPP
+#define STOPPINGCRITERIA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AtomicUtils.hpp"
+#include "Eikonal_traits.hpp"
+#include "MeshGeometry.hpp"
+#include "SolveState.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief When a solve may stop before every node is reached: past a travel
+ * time, once some target nodes have their values, or at the boundary of a
+ * region of interest. The criteria combine; none is set by default.
+ *
+ * @tparam PHDIM Dimension of the problem space.
+ */
+template <unsigned int PHDIM> struct StoppingCriteria {
+  using Point = typename Eikonal_traits<PHDIM>::Point;
+
+  //! Largest travel time wanted: nodes beyond it are left unreached.
+  double maxTime = std::numeric_limits<double>::infinity();
+  //! Node ids whose values are wanted: nodes beyond the largest of them are
+  //! left unreached.
+  std::vector<unsigned int> targets;
+  //! Whether the propagation is confined to the box [lower, upper].
+  bool hasRegion = false;
+  Point lower = Point::Zero();
+  Point upper = Point::Zero();
+
+  /**
+   * @brief Confine the propagation to the nodes in the box [lower, upper]:
+   * the values inside are the travel times along paths inside it.
+   */
+  void setRegion(const Point &lower, const Point &upper) {
+    hasRegion = true;
+    this->lower = lower;
+    this->upper = upper;
+  }
+};
+
+/**
+ * @brief The StoppingCriteria of a solve, as the solvers apply them.
+ *
+ * A node is admitted (solved, activated) only if it is in the region and its
+ * value is not above the limit: the cutoff (maxTime, lowered to the largest
+ * value of the targets once they all have one) plus the largest travel time
+ * along an edge. A value comes from the values of its neighbours, which are
+ * at most one edge later, so the values below the cutoff are still those of a
+ * full solve: a node dropped while its value was too large is reached again
+ * by its neighbours once they converge. Values only decrease, so a limit
+ * computed from older values is larger, and still safe. The nodes past the
+ * cutoff are set to unreached at the end.
+ *
+ * Disabled by default: every node is then admitted.
+ */
+template <unsigned int PHDIM> class EarlyTermination {
+public:
+  /**
+   * @brief Apply the criteria to the nodes of a mesh.
+   *
+   * @throw std::invalid_argument If a target is not a node of the mesh.
+   */
+  void enable(const StoppingCriteria<PHDIM> &criteria,
+              const MeshGeometry<PHDIM> &geometry) {
+    for (auto id : criteria.targets) {
+      if (id >= geometry.numNodes() || !geometry.hasNode(id)) {
+        throw std::invalid_argument("Target node " + std::to_string(id) +
+                                    " is not in the mesh");
+      }
+    }
+    maxTime = criteria.maxTime;
+    targets = criteria.targets;
+    margin = geometry.longestEdge();
+    inRegion.clear();
+    if (criteria.hasRegion) {
+      inRegion.resize(geometry.numNodes());
+      for (std::size_t id = 0; id < inRegion.size(); ++id) {
+        const auto &p = geometry.point(id);
+        inRegion[id] = (p.array() >= criteria.lower.array()).all() &&
+                       (p.array() <= criteria.upper.array()).all();
+      }
+    }
+    criteriaSet = true;
+  }
+
+  void disable() { *this = EarlyTermination(); }
+
+  bool enabled() const { return criteriaSet; }
+
+  /**
+   * @brief The largest value admitted while solving, given the values of the
+   * nodes.
+   */
+  double threshold(const NodeValues &u) const {
+    return cutoff(u) + margin;
+  }
+
+  bool inside(std::size_t id) const {
+    return inRegion.empty() || inRegion[id];
+  }
+
+  bool admits(std::size_t id, double value, double threshold) const {
+    return value <= threshold && inside(id);
+  }
+
+  /**
+   * @brief Set every node past the cutoff or outside the region, but the
+   * sources, to unreached.
+   */
+  void finish(NodeValues &u,
+              const numa::PartitionedVector<char> &isSource,
+              double unreached) const {
+    const double limit = cutoff(u);
+    for (std::size_t id = 0; id < u.size(); ++id) {
+      if (!isSource[id] && !admits(id, u[id], limit)) {
+        u[id] = unreached;
+      }
+    }
+  }
+
+private:
+  //! The largest value kept.
+  double cutoff(const NodeValues &u) const {
+    if (targets.empty()) {
+      return maxTime;
+    }
+    double largest = 0.0;
+    for (auto id : targets) {
+      largest = std::max(largest, atomicLoad(u[id]));
+    }
+    return std::min(maxTime, largest);
+  }
+
+  bool criteriaSet = false;
+  double maxTime = std::numeric_limits<double>::infinity();
+  std::vector<unsigned int> targets;
+  //! The largest travel time along an edge.
+  double margin = 0.0;
+  //! Whether every node is in the region, empty without a region.
+  std::vector<char> inRegion;
+};
+
+} // namespace Eikonal
+
+#endif // STOPPINGCRITERIA_HPP
@@ -0,0 +1,103 @@
+#ifndef TOLERANCESCHEDULE_HPP
+#define TOLERANCESCHEDULE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "AtomicUtils.hpp"
+#include "solveEikonalLocalProblem.hpp"
+
+namespace Eikonal {
+
+/**
+ * @brief Tolerances of the iterative local solvers as a function of how much
+ * the value of a node is still changing.
+ *
+ * Early in the propagation a value is far from final and a tight local solve
+ * is wasted: the tolerance of a solve is ratio times the last change of the
+ * node, clamped to [accuracy, loosest]. A node is only declared converged
+ * after a solve at accuracy, so the result has the accuracy of a run with
+ * fixed tolerances.
+ */
+struct ToleranceSchedule {
+  //! Tolerance of the final solves, the accuracy of the result.
+  double accuracy = 1.e-5;
+  //! Loosest tolerance, while the value of a node changes a lot.
+  double loosest = 1.e-2;
+  //! Fraction of the last change of a node used as tolerance.
+  double ratio = 1.e-2;
+
+  double tolerance(double change) const {
+    return std::clamp(ratio * change, accuracy, loosest);
+  }
+};
+
+/**
+ * @brief The last change of every node and the local solver options it
+ * leads to, following a ToleranceSchedule.
+ *
+ * Disabled (empty) by default: the options are then used as they are. The
+ * changes are read and written atomically, so the parallel engines may share
+ * them; a stale change only affects the tolerance of one solve.
+ */
+class AdaptiveTolerance {
+public:
+  /**
+   * @brief Follow a schedule for num_nodes nodes, none changed yet.
+   */
+  void enable(std::size_t num_nodes, const ToleranceSchedule &schedule) {
+    this->schedule = schedule;
+    change.assign(num_nodes, unknown);
+  }
+
+  void disable() { change.clear(); }
+
+  bool enabled() const { return !change.empty(); }
+
+  const ToleranceSchedule &getSchedule() const { return schedule; }
+
+  /**
+   * @brief The options of the next local solves of a node.
+   *
+   * @param base The options of the solver: everything but the tolerances.
+   */
+  LocalSolverOptions options(std::size_t id, LocalSolverOptions base) const {
+    if (enabled()) {
+      const double tolerance = schedule.tolerance(atomicLoad(change[id]));
+      base.optimization.relTol = tolerance;
+      base.optimization.absTol = tolerance;
+    }
+    return base;
+  }
+
+  /**
+   * @brief Whether a solve with these options may declare a node converged.
+   */
+  bool isFinal(const LocalSolverOptions &options) const {
+    return !enabled() || options.optimization.absTol <= schedule.accuracy;
+  }
+
+  /**
+   * @brief Remember by how much the last solve changed the value of a node.
+   * The solvers do not call it for the first value of a node, reached from
+   * infinity: its change stays unknown.
+   */
+  void record(std::size_t id, double value_change) {
+    if (enabled()) {
+      atomicStore(change[id], value_change);
+    }
+  }
+
+private:
+  //! Change of a node not solved yet: its first solve is at accuracy, so a
+  //! node reached once and never lowered again needs no second solve.
+  static constexpr double unknown = 0.0;
+
+  ToleranceSchedule schedule;
+  std::vector<double> change;
+};
+
+} // namespace Eikonal
+
+#endif // TOLERANCESCHEDULE_HPP
@@ -2,13 +2,41 @@
 #define VTK_WRITER_HPP
 
 #include <fstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 #include "Mesh.hpp"
 
 template<unsigned int PHDIM>
 class VTKWriter {
 public:
+    // A named field of the nodes, by node id, copied from any vector of
+    // doubles (e.g. getValues() of a solver)
+    struct Field {
+        std::string name;
+        std::vector<double> values;
+
+        template<typename Values>
+        Field(std::string name, const Values& values)
+            : name(std::move(name)), values(values.begin(), values.end()) {}
+    };
+    // A named integer field of the nodes, e.g. the source labels
+    using LabelField = std::pair<std::string, std::vector<int>>;
+
     static void write(const std::string& filename, const Mesh<PHDIM>& mesh) {
+        std::vector<double> solution(mesh.nodes.size());
+        for (const auto& node : mesh.nodes) {
+            solution[node->id] = node->u;
+        }
+        write(filename, mesh, {Field{"solution", std::move(solution)}});
+    }
+
+    // The mesh with one SCALARS section per field, e.g. the K solutions of a
+    // MultiSourceEikonalSolver, then one int SCALARS section per label field,
+    // e.g. the source_id of getSourceLabels()
+    static void write(const std::string& filename, const Mesh<PHDIM>& mesh, const std::vector<Field>& fields,
+                      const std::vector<LabelField>& labels = {}) {
         std::ofstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Unable to open file for writing: " + filename);
@@ -45,14 +73,29 @@ public:
         }
 
         file << "\nPOINT_DATA " << mesh.nodes.size() << "\n";
-        file << "SCALARS solution double 1\n";
-        file << "LOOKUP_TABLE default\n";
-        for (const auto& node : mesh.nodes) {
-            file << node->u << "\n";
+        for (const auto& [name, values] : fields) {
+            write_field(file, mesh, name, "double", values);
+        }
+        for (const auto& [name, values] : labels) {
+            write_field(file, mesh, name, "int", values);
         }
 
         file.close();
     }
+
+private:
+    template<typename T>
+    static void write_field(std::ofstream& file, const Mesh<PHDIM>& mesh, const std::string& name,
+                            const std::string& type, const std::vector<T>& values) {
+        file << "SCALARS " << name << " " << type << " 1\n";
+        file << "LOOKUP_TABLE default\n";
+        for (const auto& node : mesh.nodes) {
+            if (node->id >= values.size()) {
+                throw std::runtime_error("Field " + name + " has no value for node " + std::to_string(node->id));
+            }
+            file << values[node->id] << "\n";
+        }
+    }
 };
 
 #endif // VTK_WRITER_HPP
@@ -2,6 +2,7 @@
 #define LOAD_MESH_HPP
 
 #include <array>
+#include <map>
 #include <vector>
 #include <fstream>
 #include <iostream>
@@ -21,6 +22,8 @@ public:
         mesh.Points.clear();
         mesh.nodes.clear();
         mesh.mesh_elements.clear();
+        mesh.pointData.clear();
+        mesh.cellData.clear();
 
         std::string header_line;
         for (int i = 0; i < 4; ++i) {
@@ -96,9 +99,147 @@ public:
             mesh.mesh_elements.push_back(Mesh_element<PHDIM>{element_nodes});
         }
 
+        read_data(mesh_file, mesh);
         mesh_file.close();
         return mesh.mesh_elements;
     }
+
+private:
+    // The sections after the cells: CELL_TYPES is skipped, the SCALARS,
+    // TENSORS (9 components, by rows), TENSORS6 (6 components: xx yy zz xy yz
+    // xz) and FIELD arrays of POINT_DATA and CELL_DATA go to mesh.pointData
+    // and mesh.cellData. The arrays of the other attributes (VECTORS, NORMALS,
+    // TEXTURE_COORDINATES, COLOR_SCALARS, LOOKUP_TABLE) and METADATA blocks
+    // are skipped, and so is any other section up to the next one known
+    static void read_data(std::ifstream& mesh_file, Mesh<PHDIM>& mesh) {
+        std::map<std::string, typename Mesh<PHDIM>::DataArray>* data = nullptr;
+        std::size_t count = 0;
+        std::string section_marker;
+        bool pending = false; // section_marker was read while skipping
+        while (pending || mesh_file >> section_marker) {
+            pending = false;
+            if (section_marker == "CELL_TYPES") {
+                std::size_t num_types;
+                mesh_file >> num_types;
+                skip_values(mesh_file, num_types);
+            } else if (section_marker == "POINT_DATA" || section_marker == "CELL_DATA") {
+                mesh_file >> count;
+                const std::size_t expected =
+                    section_marker == "POINT_DATA" ? mesh.nodes.size() : mesh.mesh_elements.size();
+                if (count != expected) {
+                    throw std::runtime_error(section_marker + " size does not match the mesh");
+                }
+                data = section_marker == "POINT_DATA" ? &mesh.pointData : &mesh.cellData;
+            } else if (section_marker == "SCALARS" && data) {
+                // SCALARS name type [components], then LOOKUP_TABLE name
+                std::string name, data_type, token;
+                mesh_file >> name >> data_type >> token;
+                unsigned int components = 1;
+                if (token != "LOOKUP_TABLE") {
+                    components = static_cast<unsigned int>(std::stoul(token));
+                    mesh_file >> token;
+                }
+                mesh_file >> token; // The name of the lookup table
+                read_array(mesh_file, (*data)[name], components, count);
+            } else if ((section_marker == "TENSORS" || section_marker == "TENSORS6") && data) {
+                // TENSORS name type, no lookup table
+                std::string name, data_type;
+                mesh_file >> name >> data_type;
+                read_array(mesh_file, (*data)[name], section_marker == "TENSORS" ? 9 : 6, count);
+            } else if (section_marker == "FIELD" && data) {
+                // FIELD name arrays, then name components tuples type per array
+                std::string field_name;
+                std::size_t num_arrays;
+                mesh_file >> field_name >> num_arrays;
+                for (std::size_t i = 0; i < num_arrays; ++i) {
+                    std::string name, data_type;
+                    unsigned int components;
+                    std::size_t tuples;
+                    mesh_file >> name;
+                    if (name == "METADATA") {
+                        skip_metadata(mesh_file);
+                        mesh_file >> name;
+                    }
+                    mesh_file >> components >> tuples >> data_type;
+                    if (tuples != count) {
+                        throw std::runtime_error("Array " + name + " size does not match the mesh");
+                    }
+                    read_array(mesh_file, (*data)[name], components, count);
+                }
+            } else if ((section_marker == "VECTORS" || section_marker == "NORMALS") && data) {
+                // VECTORS name type
+                std::string name, data_type;
+                mesh_file >> name >> data_type;
+                skip_values(mesh_file, 3 * count);
+            } else if (section_marker == "TEXTURE_COORDINATES" && data) {
+                // TEXTURE_COORDINATES name dimension type
+                std::string name, data_type;
+                std::size_t dimension;
+                mesh_file >> name >> dimension >> data_type;
+                skip_values(mesh_file, dimension * count);
+            } else if (section_marker == "COLOR_SCALARS" && data) {
+                // COLOR_SCALARS name components
+                std::string name;
+                std::size_t components;
+                mesh_file >> name >> components;
+                skip_values(mesh_file, components * count);
+            } else if (section_marker == "LOOKUP_TABLE") {
+                // LOOKUP_TABLE name size, then size rgba colors
+                std::string name;
+                std::size_t size;
+                mesh_file >> name >> size;
+                skip_values(mesh_file, 4 * size);
+            } else if (section_marker == "METADATA") {
+                skip_metadata(mesh_file);
+            } else {
+                // Unknown: its tokens up to the next section known
+                while (mesh_file >> section_marker && !is_section(section_marker)) {
+                }
+                pending = static_cast<bool>(mesh_file);
+            }
+        }
+    }
+
+    static bool is_section(const std::string& token) {
+        static const char* const sections[] = {
+            "CELL_TYPES", "POINT_DATA", "CELL_DATA", "SCALARS", "TENSORS", "TENSORS6", "FIELD",
+            "VECTORS", "NORMALS", "TEXTURE_COORDINATES", "COLOR_SCALARS", "LOOKUP_TABLE", "METADATA"};
+        for (const char* section : sections) {
+            if (token == section) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void skip_values(std::ifstream& mesh_file, std::size_t num_values) {
+        std::string ignore;
+        for (std::size_t i = 0; i < num_values; ++i) {
+            if (!(mesh_file >> ignore)) {
+                throw std::runtime_error("Error reading data values");
+            }
+        }
+    }
+
+    // A METADATA block ends at the first empty line
+    static void skip_metadata(std::ifstream& mesh_file) {
+        std::string line;
+        std::getline(mesh_file, line); // The rest of the METADATA line
+        while (std::getline(mesh_file, line) &&
+               line.find_first_not_of(" \t\r") != std::string::npos) {
+        }
+    }
+
+    static void read_array(std::ifstream& mesh_file, typename Mesh<PHDIM>::DataArray& array,
+                           unsigned int components, std::size_t count) {
+        array.components = components;
+        array.values.resize(components * count);
+        for (auto& value : array.values) {
+            if (!(mesh_file >> value)) {
+                throw std::runtime_error("Error reading data values");
+            }
+        }
+    }
 };
 
 // Explicit instantiation for common use cases
@@ -33,12 +33,6 @@ int main()
         return 1;
     }
 
-    // Set source nodes (example: set first node as source)
-    if (!mesh.nodes.empty())
-    {
-        mesh.nodes[51 - 7]->isSource = true;
-    }
-
     // Create anisotropy matrix
     Mat M_matrix;
     M_matrix << 1.0, 0.0,
@@ -63,12 +57,6 @@ int main()
         return 1;
     }
 
-    // Set source nodes (example: set first node as source)
-    if (!mesh.nodes.empty())
-    {
-        mesh.nodes[51 - 7]->isSource = true;
-    }
-
     // Create anisotropy matrix
     Mat M_matrix;
     M_matrix << 1.0, 0.0, 0.0,
@@ -77,9 +65,46 @@ int main()
 
 #endif
 
-    // Initialize and run solver
-    // ParallelEikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
-    EikonalSolver<PHDIM> solver(mesh.mesh_elements, M_matrix);
+    // Sources: the POINT_DATA field source_time of the input file if there is
+    // one (a starting time per node, negative where there is no source),
+    // labelled by the field source_id if there is one too, node 44
+    // otherwise. A source anywhere in the mesh is set with
+    // Eikonal::pointSource and an Eikonal::PointLocator
+    Eikonal::BoundaryConditions boundary{{51 - 7, 0.0, 51 - 7}};
+    const auto source_time = mesh.pointData.find("source_time");
+    if (source_time != mesh.pointData.end())
+    {
+        const auto source_id = mesh.pointData.find("source_id");
+        const std::vector<double> no_labels;
+        boundary = Eikonal::boundaryValuesOf(source_time->second.values,
+                                             source_id != mesh.pointData.end() ? source_id->second.values : no_labels);
+    }
+
+    // Initialize and run solver. The CELL_DATA array anisotropy of the input
+    // file, if there is one, replaces M_matrix with a tensor per element
+    std::shared_ptr<const Eikonal::MeshGeometry<PHDIM>> geometry;
+    const auto anisotropy = mesh.cellData.find("anisotropy");
+    try
+    {
+        if (anisotropy != mesh.cellData.end())
+        {
+            geometry = std::make_shared<const Eikonal::MeshGeometry<PHDIM>>(
+                mesh.mesh_elements,
+                Eikonal::anisotropyFieldOf<PHDIM>(anisotropy->second.values, anisotropy->second.components));
+        }
+        else
+        {
+            geometry = std::make_shared<const Eikonal::MeshGeometry<PHDIM>>(mesh.mesh_elements, M_matrix);
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error in the anisotropy field: " << e.what() << std::endl;
+        return 1;
+    }
+    // ParallelEikonalSolver<PHDIM> solver(geometry, boundary);
+    // (the parallel solver also offers solver.updateAsync(), the barrier-free engine)
+    EikonalSolver<PHDIM> solver(geometry, boundary);
     solver.printResults();
 
     // Measure time for update
@@ -92,12 +117,17 @@ int main()
     solver.update();
 
     solver.printResults();
+    if constexpr (apsc::diagnostics::enabled)
+    {
+        std::clog << apsc::diagnostics::snapshot() << std::endl;
+    }
 
     // Write solution to VTK file
     try
     {
-        VTKWriter<PHDIM>::write("solution.vtk", mesh);
-        //VTKWriter<PHDIM>::write("parallel_solution.vtk", mesh);
+        VTKWriter<PHDIM>::write("solution.vtk", mesh, {{"solution", solver.getValues()}},
+                                {{"source_id", solver.getSourceLabels()}});
+        //VTKWriter<PHDIM>::write("parallel_solution.vtk", mesh, {{"solution", solver.getValues()}});
     }
     catch (const std::runtime_error &e)
     {